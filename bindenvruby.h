@@ -12,21 +12,123 @@
 #define BINDER_RUBY_NUMBER_CHECK
 #endif
 
+// define BINDER_RUBY_FAST_ARGS to read arguments straight from
+// the callee's stack frame instead of mrb_get_args(mrb, "*", ...)
+//#define BINDER_RUBY_FAST_ARGS
+
+// define BINDER_RUBY_PROFILE to record calls, latency and conversion
+// time of every bound method, compiled away if not defined
+//#define BINDER_RUBY_PROFILE
+
+// define BINDER_RUBY_WORKER_POOL to enable BindER::worker_pool,
+// N threads each running its own identically bound mruby state
+//#define BINDER_RUBY_WORKER_POOL
+
+// define BINDER_RUBY_SCRIPT_CACHE to enable BindER::script_cache,
+// compiled bytecode stored on disk and loaded by memory mapping
+//#define BINDER_RUBY_SCRIPT_CACHE
+
+// define BINDER_RUBY_ASYNC to enable BindER::async_loop and bind_async,
+// bound calls run on c++ threads while the calling fiber is suspended
+//#define BINDER_RUBY_ASYNC
+
+// native bytes allocated by bound objects between two collections
+// forced by the binder, grows with native bytes alive after collection
+#ifndef BINDER_RUBY_GC_BUDGET
+#define BINDER_RUBY_GC_BUDGET (8 << 20)
+#endif
+
+// objects count of one chunk in slab pool
+#ifndef BINDER_RUBY_POOL_CHUNK
+#define BINDER_RUBY_POOL_CHUNK 256
+#endif
+
+// bytes of inline buffer for span argument converted from ruby array,
+// larger arrays take a heap buffer
+#ifndef BINDER_RUBY_SPAN_INLINE
+#define BINDER_RUBY_SPAN_INLINE 256
+#endif
+
 // C
 #include <cassert>
+#include <cstddef>
+#include <cstring>
 
 // mruby
 #include "mruby.h"
 #include "mruby/class.h"
 #include "mruby/data.h"
 #include "mruby/proc.h"
+#include "mruby/irep.h"
+#include "mruby/opcode.h"
 #include "mruby/variable.h"
 #include "mruby/string.h"
+#include "mruby/array.h"
+#include "mruby/hash.h"
+#include "mruby/istruct.h"
+// C++17
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define BINDER_RUBY_STRING_VIEW
+#include <string_view>
+#endif
 // C++
+#include <new>
 #include <tuple>
+#include <limits>
+#include <cstdint>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <utility>
+#include <initializer_list>
+#include <type_traits>
+#include <string>
+#include <unordered_map>
+#ifdef BINDER_RUBY_WORKER_POOL
+#include "mruby/compile.h"
+#include <algorithm>
+#include <deque>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#endif
+#ifdef BINDER_RUBY_ASYNC
+#include <deque>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+#endif
+#ifdef BINDER_RUBY_SCRIPT_CACHE
+#include "mruby/compile.h"
+#include "mruby/dump.h"
+#include "mruby/irep.h"
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include <memory>
+#endif
+#ifdef BINDER_RUBY_PROFILE
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#endif
 
 // binder namespace
 namespace BindER {
+    // ruby arg to c++
+    template<typename T> struct ruby_arg;
+    // helper for data type
+    template<typename T> struct data_type_helper;
     // raise helper
     struct raise_helper {
 #ifdef BINDER_RUBY_NUMBER_CHECK
@@ -45,36 +147,186 @@ namespace BindER {
         template<size_t> 
         static void raisenarg(mrb_state *, int) { }
 #endif
+        // raise for argument type
+        static void raisetype(mrb_state *mrb, const mrb_value& value, size_t index) {
+            ::mrb_raisef(mrb, E_TYPE_ERROR, "wrong argument type %S (argument %S)",
+                ::mrb_obj_value(::mrb_obj_class(mrb, value)),
+                mrb_fixnum_value(mrb_int(index + 1))
+            );
+        }
+        // raise for element of batch call
+        static void raiseelem(mrb_state *mrb, const mrb_value& value, mrb_int index) {
+            ::mrb_raisef(mrb, E_TYPE_ERROR, "wrong element type %S (element %S)",
+                ::mrb_obj_value(::mrb_obj_class(mrb, value)),
+                mrb_fixnum_value(index)
+            );
+        }
+        // raise for field
+        static void raisefield(mrb_state *mrb, const mrb_value& value, mrb_sym field) {
+            ::mrb_raisef(mrb, E_TYPE_ERROR, "wrong type %S for field '%S'",
+                ::mrb_obj_value(::mrb_obj_class(mrb, value)),
+                ::mrb_symbol_value(field)
+            );
+        }
+        // raise for value of bound class
+        static void raisevalue(mrb_state *mrb, const mrb_value& value, RClass* cla) {
+            ::mrb_raisef(mrb, E_TYPE_ERROR, "wrong argument type %S (expected %S)",
+                ::mrb_obj_value(::mrb_obj_class(mrb, value)),
+                ::mrb_obj_value(cla)
+            );
+        }
+        // raise for array
+        static void raisearray(mrb_state *mrb, const mrb_value& value) {
+            ::mrb_raisef(mrb, E_TYPE_ERROR, "wrong argument type %S (expected Array)",
+                ::mrb_obj_value(::mrb_obj_class(mrb, value))
+            );
+        }
+    };
+    // bit of value type in type mask
+    static inline constexpr uint32_t type_bit(mrb_vtype tt) noexcept { return uint32_t(1) << tt; }
+    static_assert(MRB_TT_MAXDEFINE <= 32, "type mask is 32-bit");
+    // type mask for any type
+    enum : uint32_t { type_any = ~uint32_t(0) };
+    // type mask for number
+    enum : uint32_t { type_number = type_bit(MRB_TT_FIXNUM) | type_bit(MRB_TT_FLOAT) };
+    // arguments helper
+    struct args_helper {
+        // get arguments of current call by mrb_get_args
+        static auto parse(mrb_state* mrb, int& narg) noexcept {
+            mrb_value* args; 
+            ::mrb_get_args(mrb, "*", &args, &narg);
+            return args;
+        }
+        // get arguments of current call from the frame, parse for splat call
+        static auto frame(mrb_state* mrb, int& narg) noexcept {
+            // arguments follow self in the frame, argc < 0 for splat call
+            const auto ci = mrb->c->ci;
+            if (ci->argc >= 0) {
+                narg = ci->argc;
+                return mrb->c->stack + 1;
+            }
+            return args_helper::parse(mrb, narg);
+        }
+        // get arguments of current call
+        static auto get(mrb_state* mrb, int& narg) noexcept {
+#ifdef BINDER_RUBY_FAST_ARGS
+            return args_helper::frame(mrb, narg);
+#else
+            return args_helper::parse(mrb, narg);
+#endif
+        }
     };
     // return original parameter/argument
     template<size_t id> struct original_parameter {};
-    // helper for data object alloc
-    template<typename T> 
-    auto mrb_data_object_alloc_helper(mrb_state* ms, void*data) noexcept {
-        return ::mrb_data_object_alloc(ms, 
-            data_type_helper<T>::get_type().classr,
-            data,
-            &data_type_helper<T>::get_type().mrb_dt
-        );
+    // span of contiguous objects, borrowed from ruby object
+    template<typename T> struct span {
+        // data
+        T*              data;
+        // count of objects
+        size_t          size;
+        // begin
+        auto begin() const noexcept { return data; }
+        // end
+        auto end() const noexcept { return data + size; }
+    };
+    // buffer for span argument, copied from ruby array, inline up to BINDER_RUBY_SPAN_INLINE bytes
+    template<typename T> struct span_buffer {
+        // element type
+        using value_type = typename std::remove_const<T>::type;
+        // count of inline elements
+        enum : size_t { capacity = BINDER_RUBY_SPAN_INLINE / sizeof(value_type) ? BINDER_RUBY_SPAN_INLINE / sizeof(value_type) : 1 };
+        // set size, return buffer
+        auto resize(size_t n) -> value_type* {
+            size = n;
+            if (n <= capacity) return local;
+            heap.resize(n);
+            return heap.data();
+        }
+        // to span
+        operator span<T>() const noexcept { return span<T>{ size <= capacity ? local : heap.data(), size }; }
+        // inline buffer
+        value_type                  local[capacity];
+        // heap buffer for large array
+        std::vector<value_type>     heap;
+        // count of elements
+        size_t                      size = 0;
+    };
+    // static or long-lived string, returned to ruby without copy
+    struct static_string {
+        // ctor, 'str' must outlive every ruby string made from it
+        constexpr static_string(const char* str, size_t len) noexcept : data(str), size(len) {}
+        // data
+        const char*     data;
+        // length in byte
+        size_t          size;
+    };
+    // literals
+    namespace literals {
+        // string literal as static_string, e.g. "Foo"_static
+        constexpr static_string operator"" _static(const char* str, size_t len) noexcept { return static_string(str, len); }
     }
-    // helper for data type
+    // type id counter
+    struct type_id_counter {
+        // next id
+        static size_t next() noexcept { 
+            static std::atomic<size_t> counter(0);
+            return counter++;
+        }
+    };
+    // type id, index of per-type data in state context
+    template<typename T> struct type_id {
+        // get id
+        static auto get() noexcept { 
+            static const size_t id = type_id_counter::next();
+            return id;
+        }
+    };
+    // remove object of type from identity map of state, defined after state_context
+    static inline void unlink_object(mrb_state* mrb, const void* ptr, size_t type) noexcept;
+    // returned object owned by ruby, deleted by GC
+    template<typename T> struct owned { 
+        // ctor
+        explicit owned(T* ptr) noexcept : ptr(ptr) {}
+        // object
+        T*      ptr;
+    };
+    // owned or not
+    template<typename T> struct is_owned : std::false_type {};
+    // owned
+    template<typename T> struct is_owned<owned<T>> : std::true_type {};
+    // class passed by value, opt-in for class bound by bind_value/bind_class:
+    // template<> struct BindER::value_class<Vec3> : std::true_type {};
+    template<typename T> struct value_class : std::false_type {};
+    // returned object owned by c++, never deleted by ruby, same as T* or T&
+    template<typename T> struct borrowed { 
+        // ctor
+        explicit borrowed(T* ptr) noexcept : ptr(ptr) {}
+        // object
+        T*      ptr;
+    };
+    // helper for data type, shared by every mruby state, class is kept per state in state_context
     template<typename T> struct data_type_helper {
-        // data_type
-        struct data_type { mrb_data_type mrb_dt; RClass* classr; };
-        // get uni data type
-        static auto& get_type() noexcept {
-            static data_type datatype;
+        // get data type, shared by every state, struct_name is the name of the first bound class in any state:
+        // one c++ type is bound under one ruby name
+        static auto& get_type(const char* name = nullptr) noexcept {
+            static const std::string type_name(name ? name : "");
+            static const mrb_data_type datatype = {
+                type_name.c_str(), [](mrb_state* mrb, void* ptr) { 
+                    if (!ptr) return;
+                    unlink_object(mrb, ptr, type_id<T>::get());
+                    delete static_cast<T*>(ptr);
+                }
+            };
             return datatype;
         }
-        // init it
-        static void set_type(const char* name, RClass* classr) noexcept {
-            data_type_helper<T>::get_type().mrb_dt = {
-                name, [](mrb_state* mrb, void* ptr) { 
-                    (void)mrb; 
-                    if (ptr) delete static_cast<T*>(ptr);
+        // get data type of borrowed object, never deleted
+        static auto& get_borrowed_type() noexcept {
+            static const mrb_data_type datatype = {
+                data_type_helper::get_type().struct_name, [](mrb_state* mrb, void* ptr) { 
+                    if (ptr) unlink_object(mrb, ptr, type_id<T>::get());
                 }
             };
-            data_type_helper<T>::get_type().classr = classr;
+            return datatype;
         }
     };
     // to match ruby-style, use low-case char
@@ -90,46 +342,978 @@ namespace BindER {
         // arg type
         template <size_t i> struct arg { using type = typename std::tuple_element<i, std::tuple<Args...>>::type; };
     };
+#ifdef __cpp_noexcept_function_type
+    // type helper: noexcept is part of function type since C++17
+    template <typename ClassType, typename ReturnType, typename... Args>
+    struct type_helper<ReturnType(ClassType::*)(Args...) const noexcept> 
+        : type_helper<ReturnType(ClassType::*)(Args...) const> {};
+#endif
+    // type helper for function pointer
+    template <typename ReturnType, typename... Args>
+    struct type_helper<ReturnType(*)(Args...)> {
+        // number of arguments
+        enum : size_t { arity = sizeof...(Args) };
+        // return type
+        using result_type = ReturnType;
+        // arg type
+        template <size_t i> struct arg { using type = typename std::tuple_element<i, std::tuple<Args...>>::type; };
+    };
+#ifdef __cpp_noexcept_function_type
+    // type helper for noexcept function pointer
+    template <typename ReturnType, typename... Args>
+    struct type_helper<ReturnType(*)(Args...) noexcept> : type_helper<ReturnType(*)(Args...)> {};
+#endif
+    // arg getter, ruby_arg<T>::get(mrb, value) if given, otherwise ruby_arg<T>::get(value)
+    template<typename T, typename = void> struct arg_getter {
+        // get
+        static decltype(auto) get(mrb_state*, const mrb_value& v) noexcept { return ruby_arg<T>::get(v); }
+    };
+    // arg getter, with mruby state
+    template<typename T> 
+    struct arg_getter<T, decltype(void(ruby_arg<T>::get(std::declval<mrb_state*>(), std::declval<const mrb_value&>())))> {
+        // get
+        static decltype(auto) get(mrb_state* mrb, const mrb_value& v) noexcept { return ruby_arg<T>::get(mrb, v); }
+    };
+    // type mask helper, ruby_arg<T>::mask or any type if not given
+    template<typename T, typename = void> struct mask_helper { enum : uint32_t { value = type_any }; };
+    // type mask helper
+    template<typename T> struct mask_helper<T, decltype(void(ruby_arg<T>::mask))> { 
+        enum : uint32_t { value = ruby_arg<T>::mask }; 
+    };
+    // type mask helper in overload set, ruby_arg<T>::overload_mask or mask if not given
+    template<typename T, typename = void> struct overload_mask_helper { enum : uint32_t { value = mask_helper<T>::value }; };
+    // type mask helper in overload set
+    template<typename T> struct overload_mask_helper<T, decltype(void(ruby_arg<T>::overload_mask))> { 
+        enum : uint32_t { value = ruby_arg<T>::overload_mask }; 
+    };
+    // element checker in overload set, ruby_arg<T>::overload_mismatch(value) if given, or mismatch(value)
+    template<typename T, typename = void> struct overload_elem_helper {
+        // mismatch
+        static mrb_int mismatch(const mrb_value& v) noexcept { return ruby_arg<T>::mismatch(v); }
+    };
+    // element checker in overload set, with own one
+    template<typename T> 
+    struct overload_elem_helper<T, decltype(void(ruby_arg<T>::overload_mismatch(std::declval<const mrb_value&>())))> {
+        // mismatch
+        static mrb_int mismatch(const mrb_value& v) noexcept { return ruby_arg<T>::overload_mismatch(v); }
+    };
+    // element checker, ruby_arg<T>::mismatch(value) if given: index of first mismatched element of array, -1 if none
+    template<typename T, typename = void> struct arg_checker {
+        // mismatch
+        static mrb_int mismatch(const mrb_value&) noexcept { return -1; }
+        // mismatch in overload set
+        static mrb_int overload_mismatch(const mrb_value&) noexcept { return -1; }
+        // check, raise TypeError if mismatched
+        static void check(mrb_state*, const mrb_value&) noexcept { }
+    };
+    // element checker, with elements
+    template<typename T> 
+    struct arg_checker<T, decltype(void(ruby_arg<T>::mismatch(std::declval<const mrb_value&>())))> {
+        // mismatch
+        static mrb_int mismatch(const mrb_value& v) noexcept { return ruby_arg<T>::mismatch(v); }
+        // mismatch in overload set
+        static mrb_int overload_mismatch(const mrb_value& v) noexcept { return overload_elem_helper<T>::mismatch(v); }
+        // check, raise TypeError if mismatched
+        static void check(mrb_state* mrb, const mrb_value& v) noexcept {
+            const auto index = ruby_arg<T>::mismatch(v);
+            if (index >= 0) raise_helper::raiseelem(mrb, RARRAY_PTR(v)[index], index);
+        }
+    };
+    // object checker, ruby_arg<T>::accept(mrb, value) if given: false if not an object of the bound class
+    template<typename T, typename = void> struct object_checker {
+        // accept
+        static bool accept(mrb_state*, const mrb_value&) noexcept { return true; }
+        // check, raise TypeError if not accepted
+        static void check(mrb_state*, const mrb_value&) noexcept { }
+    };
+    // object checker, with bound class
+    template<typename T> 
+    struct object_checker<T, decltype(void(ruby_arg<T>::accept(std::declval<mrb_state*>(), std::declval<const mrb_value&>())))> {
+        // accept
+        static bool accept(mrb_state* mrb, const mrb_value& v) noexcept { return ruby_arg<T>::accept(mrb, v); }
+        // check, raise TypeError if not accepted
+        static void check(mrb_state* mrb, const mrb_value& v) noexcept {
+            if (!ruby_arg<T>::accept(mrb, v)) ruby_arg<T>::raise(mrb, v);
+        }
+    };
     // call c++ function
     template<size_t ArgNum> struct call_chain {
-        // check
-        template<typename TypeHelper, typename T, typename RubyArgType, typename... Args>
-        static auto check(T lam, RubyArgType* list, Args&&... args) noexcept { 
-            constexpr size_t NEXT = ArgNum - 1;
-            constexpr size_t INDEX = TypeHelper::arity - ArgNum;
-            using parma_type = TypeHelper::arg<INDEX>::type;
-            return call_chain<NEXT>::check<TypeHelper>(
-                lam, list, std::forward<Args>(args)..., ruby_arg<parma_type>::check(list[INDEX])
-                );
-        }
         // call
         template<typename TypeHelper, typename T, typename RubyArgType, typename... Args>
-        static auto call(T lam, RubyArgType* list, Args&&... args) noexcept { 
+        static decltype(auto) call(mrb_state* mrb, T& lam, RubyArgType* list, Args&&... args) noexcept { 
             constexpr size_t NEXT = ArgNum - 1;
             constexpr size_t INDEX = TypeHelper::arity - ArgNum;
-            using parma_type = TypeHelper::arg<INDEX>::type;
-            return call_chain<NEXT>::call<TypeHelper>(
-                lam, list, std::forward<Args>(args)..., ruby_arg<parma_type>::get(list[INDEX])
+            using parma_type = typename TypeHelper::template arg<INDEX>::type;
+            return call_chain<NEXT>::template call<TypeHelper>(
+                mrb, lam, list, std::forward<Args>(args)..., arg_getter<parma_type>::get(mrb, list[INDEX])
                 );
         }
     };
     // base arg
     template<> struct call_chain<0> {
-        // check
+        // call
         template<typename TypeHelper, typename T, typename RubyArgType, typename... Args>
-        static auto check(T lam, RubyArgType*, Args&&...args) noexcept { return lam(std::forward<Args>(args)...); }
+        static decltype(auto) call(mrb_state*, T& lam, RubyArgType*, Args&&...args) noexcept { return lam(std::forward<Args>(args)...); }
+    };
+    // call c++ function, expand all arguments in one pass
+    template<size_t ArgNum> struct call_flat {
         // call
         template<typename TypeHelper, typename T, typename RubyArgType, typename... Args>
-        static auto call(T lam, RubyArgType*, Args&&...args) noexcept { return lam(std::forward<Args>(args)...); }
+        static decltype(auto) call(mrb_state* mrb, T& lam, RubyArgType* list, Args&&... args) noexcept {
+            return call_flat::template call_index<TypeHelper>(
+                mrb, lam, list, std::make_index_sequence<ArgNum>(), std::forward<Args>(args)...
+                );
+        }
+        // call with index
+        template<typename TypeHelper, typename T, typename RubyArgType, size_t... Index, typename... Args>
+        static decltype(auto) call_index(mrb_state* mrb, T& lam, RubyArgType* list, std::index_sequence<Index...>, Args&&... args) noexcept {
+            // leading arguments given by caller
+            constexpr size_t OFFSET = TypeHelper::arity - ArgNum;
+            (void)mrb; (void)list;
+            return lam(std::forward<Args>(args)..., 
+                arg_getter<typename TypeHelper::template arg<OFFSET + Index>::type>::get(mrb, list[OFFSET + Index])...
+                );
+        }
+    };
+#ifdef BINDER_RUBY_FAST_ARGS
+    // call helper
+    template<size_t ArgNum> using call_helper = call_flat<ArgNum>;
+#else
+    // call helper
+    template<size_t ArgNum> using call_helper = call_chain<ArgNum>;
+#endif
+    // closure helper, callable stored in env of cfunc proc
+    template<typename T, bool = std::is_empty<T>::value> struct closure_helper {
+        // data type for callable
+        static auto& get_type() noexcept {
+            static const mrb_data_type datatype = {
+                "BindER::closure", [](mrb_state* mrb, void* ptr) {
+                    (void)mrb;
+                    if (ptr) delete static_cast<T*>(ptr);
+                }
+            };
+            return datatype;
+        }
+        // get callable of current call
+        static auto& get(mrb_state* mrb) noexcept {
+            // same as mrb_cfunc_env_get(mrb, 0) without checking
+            const auto env = mrb->c->ci->proc->env->stack[0];
+            return *static_cast<const T*>(DATA_PTR(env));
+        }
+        // define method with callable, extra pointer is stored in env[1] if given
+        static void define(mrb_state* mrb, RClass* cla, const char* name, mrb_func_t func, const T& callable, void* extra = nullptr) noexcept {
+            const auto ai = ::mrb_gc_arena_save(mrb);
+            const auto ptr = new(std::nothrow) T(callable);
+            assert(ptr && "out of memory");
+            mrb_value env[2] = {
+                ::mrb_obj_value(::mrb_data_object_alloc(mrb, mrb->object_class, ptr, &get_type())),
+                ::mrb_cptr_value(mrb, extra)
+            };
+            auto proc = ::mrb_proc_new_cfunc_with_env(mrb, func, extra ? 2 : 1, env);
+            ::mrb_define_method_raw(mrb, cla, ::mrb_intern_cstr(mrb, name), proc);
+            ::mrb_gc_arena_restore(mrb, ai);
+        }
+    };
+    // closure helper for stateless callable, every object is the same one
+    template<typename T> struct closure_helper<T, true> {
+        // storage
+        static auto& storage(const T* callable = nullptr) noexcept {
+            static const T real_callable(*callable);
+            return real_callable;
+        }
+        // get callable of current call
+        static auto& get(mrb_state*) noexcept { return storage(); }
+        // define method with callable, extra pointer is stored in env[1] if given
+        static void define(mrb_state* mrb, RClass* cla, const char* name, mrb_func_t func, const T& callable, void* extra = nullptr) noexcept {
+            closure_helper::storage(&callable);
+            const auto ai = ::mrb_gc_arena_save(mrb);
+            mrb_value env[2] = { ::mrb_nil_value(), ::mrb_cptr_value(mrb, extra) };
+            auto proc = extra ? ::mrb_proc_new_cfunc_with_env(mrb, func, 2, env) : ::mrb_proc_new_cfunc(mrb, func);
+            ::mrb_define_method_raw(mrb, cla, ::mrb_intern_cstr(mrb, name), proc);
+            ::mrb_gc_arena_restore(mrb, ai);
+        }
+    };
+    // type helper for first argument, void if no argument
+    template<typename TypeHelper, bool = (TypeHelper::arity > 0)> struct first_arg { using type = void; };
+    // type helper for first argument
+    template<typename TypeHelper> struct first_arg<TypeHelper, true> { 
+        using type = typename TypeHelper::template arg<0>::type; 
+    };
+    // FNV-1a hash
+    static inline uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull) noexcept {
+        const auto bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i != size; ++i) { hash ^= bytes[i]; hash *= 0x100000001b3ull; }
+        return hash;
+    }
+    // pool stats
+    struct pool_stats {
+        // live objects
+        size_t          live;
+        // high-water mark of live objects
+        size_t          high_water;
+        // bytes reserved from heap
+        size_t          bytes;
+    };
+    // pool base
+    struct pool_base {
+        // dtor
+        virtual ~pool_base() noexcept = default;
+        // state closed, delete pool once no object alive
+        virtual void close() noexcept = 0;
+    };
+    // slab pool, objects are constructed in place and returned by the free hook of gc
+    template<typename T> class slab_pool final : public pool_base {
+        static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned type");
+        // free slot or storage of object
+        union slot { slot* next; typename std::aligned_storage<sizeof(T), alignof(T)>::type storage; };
+        // slot with owner
+        struct node { slab_pool* owner; slot data; };
+        // chunk of nodes
+        struct chunk { chunk* next; node nodes[BINDER_RUBY_POOL_CHUNK]; };
+    public:
+        // data type for pooled object
+        static auto& get_type() noexcept {
+            static const mrb_data_type datatype = {
+                "BindER::pool", [](mrb_state* mrb, void* ptr) {
+                    if (!ptr) return;
+                    unlink_object(mrb, ptr, type_id<T>::get());
+                    slab_pool::release(ptr);
+                }
+            };
+            return datatype;
+        }
+        // destruct object and return the slot to owner pool
+        static void release(void* ptr) noexcept {
+            const auto n = reinterpret_cast<node*>(static_cast<char*>(ptr) - offsetof(node, data));
+            const auto pool = n->owner;
+            static_cast<T*>(ptr)->~T();
+            n->data.next = pool->free_list;
+            pool->free_list = &n->data;
+            // bulk release after mrb_close
+            if (!--pool->stats.live && pool->closed) delete pool;
+        }
+        // acquire slot for one object, nullptr if out of memory
+        auto acquire() noexcept -> void* {
+            if (!free_list && !this->grow()) return nullptr;
+            const auto s = free_list;
+            free_list = s->next;
+            if (++stats.live > stats.high_water) stats.high_water = stats.live;
+            return s;
+        }
+        // get stats
+        auto get_stats() const noexcept { return stats; }
+        // state closed
+        void close() noexcept override { closed = true; if (!stats.live) delete this; }
+        // dtor
+        ~slab_pool() noexcept { 
+            while (chunks) { const auto next = chunks->next; delete chunks; chunks = next; }
+        }
+    private:
+        // add one chunk to free list
+        bool grow() noexcept {
+            const auto c = new(std::nothrow) chunk;
+            if (!c) return false;
+            c->next = chunks;
+            chunks = c;
+            for (auto& n : c->nodes) {
+                n.owner = this;
+                n.data.next = free_list;
+                free_list = &n.data;
+            }
+            stats.bytes += sizeof(chunk);
+            return true;
+        }
+    private:
+        // chunk list
+        chunk*          chunks = nullptr;
+        // free list
+        slot*           free_list = nullptr;
+        // stats
+        pool_stats      stats = { 0, 0, 0 };
+        // state closed
+        bool            closed = false;
+    };
+    // slot from slab pool, the first argument of pooled ctor
+    template<typename T> class pool_slot {
+    public:
+        // ctor
+        explicit pool_slot(void* ptr) noexcept : ptr(ptr) {}
+        // construct object in place
+        template<typename... Args> auto construct(Args&&... args) const noexcept {
+            return new(ptr) T(std::forward<Args>(args)...);
+        }
+    private:
+        // storage
+        void*           ptr;
+    };
+#ifdef BINDER_RUBY_PROFILE
+    // profile record of one binding
+    struct profile_record {
+        // name of class
+        std::string     class_name;
+        // name of method
+        std::string     method_name;
+        // class-method or not
+        bool            singleton;
+        // count of calls
+        uint64_t        calls;
+        // total latency in ns
+        uint64_t        total_ns;
+        // max latency in ns
+        uint64_t        max_ns;
+        // time of arguments check/get and result set in ns
+        uint64_t        convert_ns;
+    };
+    // profile counters of one binding, only written by the thread running mruby state
+    class profile_entry {
+        // load counter
+        static auto load(const std::atomic<uint64_t>& c) noexcept { return c.load(std::memory_order_relaxed); }
+        // store counter
+        static void store(std::atomic<uint64_t>& c, uint64_t v) noexcept { c.store(v, std::memory_order_relaxed); }
+    public:
+        // ctor
+        profile_entry(const char* class_name, const char* method_name, bool singleton) noexcept
+            : class_name(class_name ? class_name : ""), method_name(method_name), singleton(singleton) {}
+        // add one call, single writer: plain load and store, no lock
+        void add(uint64_t total, uint64_t body) noexcept {
+            store(calls, load(calls) + 1);
+            store(total_ns, load(total_ns) + total);
+            store(convert_ns, load(convert_ns) + (total > body ? total - body : 0));
+            if (total > load(max_ns)) store(max_ns, total);
+        }
+        // reset
+        void reset() noexcept { store(calls, 0); store(total_ns, 0); store(max_ns, 0); store(convert_ns, 0); }
+        // get record
+        auto get_record() const {
+            return profile_record{ 
+                class_name, method_name, singleton, 
+                load(calls), load(total_ns), load(max_ns), load(convert_ns) 
+            };
+        }
+    private:
+        // name of class
+        const std::string           class_name;
+        // name of method
+        const std::string           method_name;
+        // class-method or not
+        const bool                  singleton;
+        // counters
+        std::atomic<uint64_t>       calls{ 0 }, total_ns{ 0 }, max_ns{ 0 }, convert_ns{ 0 };
+    };
+#endif
+    // field bound by member pointer, type erased
+    struct field_entry {
+        // get field of object as ruby value
+        using getter = mrb_value(*)(mrb_state*, const void* obj, const field_entry&);
+        // set field of object from ruby value, false if type mismatched
+        using setter = bool(*)(mrb_state*, void* obj, const field_entry&, const mrb_value&);
+        // name
+        mrb_sym             name;
+        // getter
+        getter              get;
+        // setter, nullptr for const field
+        setter              set;
+        // member pointer
+        alignas(std::max_align_t) unsigned char member[sizeof(std::max_align_t)];
+    };
+    // entry of binding table, made by table_method
+    struct method_entry {
+        // name
+        const char*     name;
+        // static cfunc
+        mrb_func_t      func;
+        // class-method or instance-method
+        bool            singleton;
+    };
+    // method replaced by binder, called for what the binder does not handle
+    struct replaced_method {
+        // method, nullptr if none
+        RProc*          proc;
+        // class defined the method
+        RClass*         owner;
+    };
+    // binding tables of type defined on first call
+    struct lazy_table {
+        // method_missing and respond_to_missing? replaced, of class and of singleton
+        replaced_method replaced[2][2] = {};
+        // tables, first entry and count
+        std::vector<std::pair<const method_entry*, size_t>> tables;
+        // index of entries by '#name' or '.name', built on first lookup
+        std::unordered_map<std::string, const method_entry*> index;
+        // count of tables in index
+        size_t          indexed = 0;
+    };
+    // gc marker, values marked are kept alive by the wrapper until its next mark
+    class gc_marker {
+    public:
+        // ctor
+        gc_marker(mrb_state* mrb, mrb_value refs) noexcept : mrb(mrb), refs(refs) {}
+        // mark value held by c++ object
+        void mark(const mrb_value& v) noexcept { if (!mrb_immediate_p(v)) ::mrb_ary_push(mrb, refs, v); }
+    private:
+        // mruby state
+        mrb_state*      mrb;
+        // array kept by wrapper
+        mrb_value       refs;
+    };
+    // gc hooks of bound type, type erased
+    struct gc_entry {
+        // size of object by callback
+        using sizer = size_t(*)(void(*)(), const void* obj);
+        // mark values of object by callback
+        using marker = void(*)(void(*)(), const void* obj, gc_marker&);
+        // native size of object
+        auto get_size(const void* obj) const noexcept { return size ? size(size_fn, obj) : cost; }
+        // constant cost of object
+        size_t          cost = 0;
+        // size callback
+        void          (*size_fn)() = nullptr;
+        // size thunk
+        sizer           size = nullptr;
+        // mark callback
+        void          (*mark_fn)() = nullptr;
+        // mark thunk
+        marker          mark = nullptr;
+    };
+#ifdef BINDER_RUBY_ASYNC
+    // event loop of async calls, defined after state_context
+    class async_loop;
+#endif
+    // per-state context, released at mrb_close
+    class state_context {
+        // registry of contexts
+        struct registry { 
+            std::mutex mutex; std::unordered_map<mrb_state*, state_context*> map; std::atomic<uint32_t> epoch{ 1 }; 
+        };
+        // last context used by this thread, invalid once any context is closed
+        struct cache { mrb_state* mrb; state_context* ctx; uint32_t epoch; };
+        // get registry
+        static auto& get_registry() noexcept { static registry reg; return reg; }
+    public:
+        // get context of mruby state, create if not exist
+        static auto& get(mrb_state* mrb) noexcept { return *state_context::lookup(mrb, true); }
+        // find context of mruby state, nullptr if not exist or closed
+        static auto find(mrb_state* mrb) noexcept { return state_context::lookup(mrb, false); }
+        // find wrapper of object of type, nullptr if not exist
+        template<typename T> auto find_object(const void* ptr) const noexcept -> RData* {
+            const auto itr = objects.find({ ptr, type_id<T>::get() });
+            return itr == objects.end() ? nullptr : itr->second.data;
+        }
+        // add wrapper of object, native size charged to gc if owned by ruby
+        template<typename T> void link_object(mrb_state* mrb, RData* data, bool own) noexcept {
+            const auto id = type_id<T>::get();
+            const auto gc = id < gcs.size() ? &gcs[id] : nullptr;
+            auto& entry = objects[{ data->data, id }];
+            const auto charged = entry.bytes;
+            entry = { data, own && gc ? gc->get_size(data->data) : charged, id };
+            if (gc && gc->mark) this->mark_object(mrb, data, *gc);
+            if (entry.bytes > charged) this->charge(mrb, entry.bytes - charged);
+        }
+        // size or mark hook given for type, its objects are linked once created
+        template<typename T> bool has_gc() const noexcept {
+            const auto id = type_id<T>::get();
+            return id < gcs.size() && (gcs[id].cost || gcs[id].size || gcs[id].mark);
+        }
+        // remove wrapper of object of type
+        void unlink_object(const void* ptr, size_t type) noexcept { 
+            const auto itr = objects.find({ ptr, type });
+            if (itr == objects.end()) return;
+            native_bytes -= itr->second.bytes;
+            objects.erase(itr);
+        }
+        // add binding table of type defined on first call, true for the first one
+        template<typename T> bool add_lazy(const method_entry* table, size_t count) {
+            const auto id = type_id<T>::get();
+            if (lazies.size() <= id) lazies.resize(id + 1);
+            lazies[id].tables.emplace_back(table, count);
+            return lazies[id].tables.size() == 1;
+        }
+        // method of type replaced by binding tables, kept from GC until the state closes
+        template<typename T> auto& get_replaced(bool singleton, bool respond) noexcept {
+            const auto id = type_id<T>::get();
+            if (lazies.size() <= id) lazies.resize(id + 1);
+            return lazies[id].replaced[singleton][respond];
+        }
+        // find entry in binding tables of type defined on first call, nullptr if not exist
+        template<typename T> auto find_lazy(const char* name, bool singleton) -> const method_entry* {
+            const auto id = type_id<T>::get();
+            if (id >= lazies.size()) return nullptr;
+            auto& lazy = lazies[id];
+            // index tables added since last lookup, later one wins
+            for (; lazy.indexed != lazy.tables.size(); ++lazy.indexed) {
+                const auto& table = lazy.tables[lazy.indexed];
+                for (size_t i = 0; i != table.second; ++i) {
+                    const auto& entry = table.first[i];
+                    lazy.index[(entry.singleton ? '.' : '#') + std::string(entry.name)] = &entry;
+                }
+            }
+            const auto itr = lazy.index.find((singleton ? '.' : '#') + std::string(name));
+            return itr == lazy.index.end() ? nullptr : itr->second;
+        }
+        // get gc hooks for type in this state
+        template<typename T> auto& get_gc() noexcept {
+            const auto id = type_id<T>::get();
+            if (gcs.size() <= id) gcs.resize(id + 1);
+            return gcs[id];
+        }
+        // mark values held by every object with mark hook, the only snapshot after link besides forced GC
+        void mark_objects(mrb_state* mrb) noexcept {
+            // no collection while walking the identity map
+            const bool disabled = mrb->gc.disabled;
+            mrb->gc.disabled = true;
+            for (const auto& pair : objects) {
+                const auto& entry = pair.second;
+                if (entry.type < gcs.size() && gcs[entry.type].mark) this->mark_object(mrb, entry.data, gcs[entry.type]);
+            }
+            mrb->gc.disabled = disabled;
+        }
+        // symbol of Proc#call, interned once
+        auto get_call_sym(mrb_state* mrb) noexcept {
+            if (!call_sym) call_sym = mrb_intern_lit(mrb, "call");
+            return call_sym;
+        }
+        // set base budget of native bytes between collections
+        void set_gc_budget(size_t bytes) noexcept { gc_base = gc_budget = bytes; }
+        // native bytes of objects owned by ruby
+        auto get_native_bytes() const noexcept { return native_bytes; }
+        // get class bound for type in this state, nullptr if not bound
+        template<typename T> auto get_class() const noexcept {
+            const auto id = type_id<T>::get();
+            return id < classes.size() ? classes[id] : nullptr;
+        }
+        // add binding to fingerprint, independent of binding order
+        void add_binding(const char* class_name, const char* method_name, bool singleton) noexcept {
+            const char sep = singleton ? '.' : '#';
+            auto hash = fnv1a(class_name, class_name ? std::strlen(class_name) : 0);
+            hash = fnv1a(&sep, 1, hash);
+            fingerprint += fnv1a(method_name, std::strlen(method_name), hash);
+        }
+        // fingerprint of every binding in this state
+        auto get_fingerprint() const noexcept { return fingerprint; }
+#ifdef BINDER_RUBY_SCRIPT_CACHE
+        // keep mapped file read in place until the state closed, latest one found by path
+        void keep_mapping(const std::string& path, std::shared_ptr<const void> file) {
+            mappings.push_back(file);
+            latest_mappings[path] = std::move(file);
+        }
+        // find latest mapped file kept for path, nullptr if not exist
+        auto find_mapping(const std::string& path) const noexcept -> std::shared_ptr<const void> {
+            const auto itr = latest_mappings.find(path);
+            return itr == latest_mappings.end() ? nullptr : itr->second;
+        }
+#endif
+        // get fields bound for type in this state
+        template<typename T> auto& get_fields() noexcept {
+            const auto id = type_id<T>::get();
+            if (fields.size() <= id) fields.resize(id + 1);
+            return fields[id];
+        }
+        // set class bound for type in this state
+        template<typename T> void set_class(RClass* cla) noexcept {
+            const auto id = type_id<T>::get();
+            if (classes.size() <= id) classes.resize(id + 1, nullptr);
+            classes[id] = cla;
+        }
+#ifdef BINDER_RUBY_ASYNC
+        // set event loop of this state
+        void set_loop(async_loop* l) noexcept { loop = l; }
+        // get event loop of this state, nullptr if not created
+        auto get_loop() const noexcept { return loop; }
+#endif
+        // get pool for type, create if not exist
+        template<typename T> auto& get_pool() noexcept {
+            const auto id = type_id<T>::get();
+            if (pools.size() <= id) pools.resize(id + 1, nullptr);
+            if (!pools[id]) pools[id] = new(std::nothrow) slab_pool<T>;
+            assert(pools[id] && "out of memory");
+            return static_cast<slab_pool<T>&>(*pools[id]);
+        }
+        // find pool for type, nullptr if not exist
+        template<typename T> auto find_pool() const noexcept {
+            const auto id = type_id<T>::get();
+            return static_cast<slab_pool<T>*>(id < pools.size() ? pools[id] : nullptr);
+        }
+#ifdef BINDER_RUBY_PROFILE
+        // add profile entry for binding
+        auto add_profile(const char* class_name, const char* method_name, bool singleton) noexcept {
+            std::lock_guard<std::mutex> lock(profile_mutex);
+            profiles.emplace_back(new(std::nothrow) profile_entry(class_name, method_name, singleton));
+            assert(profiles.back() && "out of memory");
+            return profiles.back().get();
+        }
+        // snapshot of profile entries
+        auto get_profile() const {
+            std::lock_guard<std::mutex> lock(profile_mutex);
+            std::vector<profile_record> records;
+            records.reserve(profiles.size());
+            for (const auto& entry : profiles) records.push_back(entry->get_record());
+            return records;
+        }
+        // reset profile entries
+        void reset_profile() noexcept {
+            std::lock_guard<std::mutex> lock(profile_mutex);
+            for (const auto& entry : profiles) entry->reset();
+        }
+#endif
+    private:
+        // mark values held by object into array kept by its wrapper
+        void mark_object(mrb_state* mrb, RData* data, const gc_entry& gc) noexcept {
+            const auto ai = ::mrb_gc_arena_save(mrb);
+            if (!refs_sym) refs_sym = mrb_intern_lit(mrb, "__binder_refs__");
+            const auto self = ::mrb_obj_value(data);
+            auto refs = ::mrb_iv_get(mrb, self, refs_sym);
+            if (mrb_array_p(refs)) ::mrb_ary_clear(mrb, refs);
+            else ::mrb_iv_set(mrb, self, refs_sym, refs = ::mrb_ary_new(mrb));
+            gc_marker marker(mrb, refs);
+            gc.mark(gc.mark_fn, data->data, marker);
+            ::mrb_gc_arena_restore(mrb, ai);
+        }
+        // charge native bytes, full collection once the budget is used up, run at once in the linking call
+        void charge(mrb_state* mrb, size_t bytes) noexcept {
+            native_bytes += bytes;
+            debt += bytes;
+            if (debt < gc_budget) return;
+            debt = 0;
+            this->mark_objects(mrb);
+            ::mrb_full_gc(mrb);
+            // next collection once native bytes alive are doubled, budget at least
+            gc_budget = native_bytes > gc_base ? native_bytes : gc_base;
+        }
+        // get context of mruby state, create if not exist and 'create' is true
+        static auto lookup(mrb_state* mrb, bool create) noexcept -> state_context* {
+            static thread_local cache last = { nullptr, nullptr, 0 };
+            auto& reg = get_registry();
+            // hot path: same state as the last call of this thread
+            const auto epoch = reg.epoch.load(std::memory_order_acquire);
+            if (last.mrb == mrb && last.epoch == epoch) return last.ctx;
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            const auto itr = reg.map.find(mrb);
+            auto ctx = itr == reg.map.end() ? nullptr : itr->second;
+            if (!ctx) {
+                if (!create) return nullptr;
+                ctx = new(std::nothrow) state_context;
+                assert(ctx && "out of memory");
+                reg.map[mrb] = ctx;
+                ::mrb_state_atexit(mrb, [](mrb_state* mrb) { state_context::close(mrb); });
+            }
+            last = { mrb, ctx, epoch };
+            return ctx;
+        }
+        // close context of mruby state
+        static void close(mrb_state* mrb) noexcept {
+            auto& reg = get_registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            const auto itr = reg.map.find(mrb);
+            if (itr == reg.map.end()) return;
+            delete itr->second;
+            reg.map.erase(itr);
+            reg.epoch.fetch_add(1, std::memory_order_acq_rel);
+        }
+        // dtor
+        ~state_context() noexcept { for (auto pool : pools) if (pool) pool->close(); }
+    private:
+        // pools
+        std::vector<pool_base*>     pools;
+        // classes
+        std::vector<RClass*>        classes;
+        // fields
+        std::vector<std::vector<field_entry>> fields;
+        // object linked to wrapper
+        struct object_entry { RData* data; size_t bytes; size_t type; };
+        // object and its type, key of identity map
+        struct object_key { 
+            const void* ptr; size_t type; 
+            bool operator==(const object_key& other) const noexcept { return ptr == other.ptr && type == other.type; }
+        };
+        // hash of object_key
+        struct object_hash {
+            size_t operator()(const object_key& key) const noexcept { 
+                return std::hash<const void*>()(key.ptr) ^ (key.type * 0x9e3779b97f4a7c15ull);
+            }
+        };
+        // identity map, object of type to wrapper
+        std::unordered_map<object_key, object_entry, object_hash> objects;
+        // gc hooks
+        std::vector<gc_entry>       gcs;
+        // binding tables defined on first call
+        std::vector<lazy_table>     lazies;
+        // native bytes of objects owned by ruby
+        size_t                      native_bytes = 0;
+        // native bytes charged since last collection
+        size_t                      debt = 0;
+        // native bytes between collections
+        size_t                      gc_budget = BINDER_RUBY_GC_BUDGET;
+        // base of gc_budget
+        size_t                      gc_base = BINDER_RUBY_GC_BUDGET;
+        // name of wrapper's array for marked values
+        mrb_sym                     refs_sym = 0;
+        // symbol of Proc#call
+        mrb_sym                     call_sym = 0;
+#ifdef BINDER_RUBY_ASYNC
+        // event loop
+        async_loop*                 loop = nullptr;
+#endif
+        // fingerprint of bindings
+        uint64_t                    fingerprint = 0;
+#ifdef BINDER_RUBY_SCRIPT_CACHE
+        // mapped files, ireps read in place point into them
+        std::vector<std::shared_ptr<const void>> mappings;
+        // latest mapped file by path
+        std::unordered_map<std::string, std::shared_ptr<const void>> latest_mappings;
+#endif
+#ifdef BINDER_RUBY_PROFILE
+        // mutex for profile entries, not used by calls
+        mutable std::mutex          profile_mutex;
+        // profile entries
+        std::vector<std::unique_ptr<profile_entry>> profiles;
+#endif
+    };
+#ifdef BINDER_RUBY_PROFILE
+    // profile probe of one call, reads entry from env[1] of current method
+    class profile_probe {
+        // clock
+        using clock = std::chrono::steady_clock;
+        // to ns
+        static auto to_ns(clock::duration d) noexcept { 
+            return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()); 
+        }
+        // callable with body timed, nothing with dtor lives across a raise
+        template<typename T> struct timed {
+            // call
+            template<typename... Args> decltype(auto) operator()(Args&&... args) const noexcept {
+                using result_type = decltype(callable(std::forward<Args>(args)...));
+                return this->call(std::is_void<result_type>(), std::forward<Args>(args)...);
+            }
+            // call without result
+            template<typename... Args> void call(std::true_type, Args&&... args) const noexcept {
+                const auto start = clock::now();
+                callable(std::forward<Args>(args)...);
+                probe.body_ns += to_ns(clock::now() - start);
+            }
+            // call with result
+            template<typename... Args> decltype(auto) call(std::false_type, Args&&... args) const noexcept {
+                const auto start = clock::now();
+                decltype(auto) result = callable(std::forward<Args>(args)...);
+                probe.body_ns += to_ns(clock::now() - start);
+                return result;
+            }
+            // callable
+            const T&            callable;
+            // probe
+            profile_probe&      probe;
+        };
+    public:
+        // add entry for binding
+        static void* attach(mrb_state* mrb, RClass* cla, const char* name, bool singleton) noexcept {
+            return state_context::get(mrb).add_profile(::mrb_class_name(mrb, cla), name, singleton);
+        }
+        // ctor
+        explicit profile_probe(mrb_state* mrb) noexcept 
+            : entry(static_cast<profile_entry*>(mrb_cptr(mrb->c->ci->proc->env->stack[1]))), start(clock::now()) {}
+        // record returned call, no dtor: a raise longjmps over the probe and is not counted
+        auto finish(mrb_value result) noexcept { entry->add(to_ns(clock::now() - start), body_ns); return result; }
+        // wrap callable to time body
+        template<typename T> auto wrap(const T& callable) noexcept { return timed<T>{ callable, *this }; }
+    private:
+        // entry
+        profile_entry*      entry;
+        // start time
+        clock::time_point   start;
+        // time of body
+        uint64_t            body_ns = 0;
+    };
+    // dump profile records as text or json, keyed by class and method name
+    static inline auto dump_profile(const std::vector<profile_record>& records, bool json) {
+        std::string out(json ? "[\n" : "");
+        char buf[128];
+        for (size_t i = 0; i != records.size(); ++i) {
+            const auto& r = records[i];
+            const auto name = r.class_name + (r.singleton ? "." : "#") + r.method_name;
+            const auto avg = r.calls ? double(r.total_ns) / double(r.calls) : 0.0;
+            if (json) {
+                out += "  { \"name\": \"" + name + "\", ";
+                std::snprintf(buf, sizeof(buf), 
+                    "\"calls\": %llu, \"total_ns\": %llu, \"max_ns\": %llu, \"convert_ns\": %llu }%s\n",
+                    (unsigned long long)r.calls, (unsigned long long)r.total_ns, 
+                    (unsigned long long)r.max_ns, (unsigned long long)r.convert_ns,
+                    i + 1 == records.size() ? "" : ","
+                );
+            }
+            else {
+                out += name;
+                out.append(name.size() < 32 ? 32 - name.size() : 1, ' ');
+                std::snprintf(buf, sizeof(buf), "calls %10llu  avg %10.1f ns  max %10llu ns  convert %5.1f%%\n",
+                    (unsigned long long)r.calls, avg, (unsigned long long)r.max_ns,
+                    r.total_ns ? 100.0 * double(r.convert_ns) / double(r.total_ns) : 0.0
+                );
+            }
+            out += buf;
+        }
+        if (json) out += "]\n";
+        return out;
+    }
+#else
+    // profile probe, nothing if BINDER_RUBY_PROFILE not defined
+    struct profile_probe {
+        // add entry for binding
+        static void* attach(mrb_state*, RClass*, const char*, bool) noexcept { return nullptr; }
+        // ctor
+        explicit profile_probe(mrb_state*) noexcept {}
+        // record returned call, same result
+        static auto finish(mrb_value result) noexcept { return result; }
+        // wrap callable, same one
+        template<typename T> static auto& wrap(const T& callable) noexcept { return callable; }
+    };
+#endif
+    // remove object of type from identity map of state, nothing after the state closed
+    static inline void unlink_object(mrb_state* mrb, const void* ptr, size_t type) noexcept {
+        if (const auto ctx = state_context::find(mrb)) ctx->unlink_object(ptr, type);
+    }
+    // value helper, trivially copyable object fitting in MRB_TT_ISTRUCT can be stored inline
+    template<typename T, bool = std::is_trivially_copyable<T>::value 
+        && sizeof(T) <= ISTRUCT_DATA_SIZE && alignof(T) <= alignof(void*)> struct value_helper {
+        // stored inline or not
+        enum : bool { value = false };
+        // object in place, never
+        static auto get(mrb_state*, const mrb_value&) noexcept -> T* { return nullptr; }
+        // new ruby object, never
+        static auto set(mrb_state*, RClass*, const T&) noexcept { assert(!"not value type"); return ::mrb_nil_value(); }
+    };
+    // value helper, stored inline
+    template<typename T> struct value_helper<T, true> {
+        // stored inline or not
+        enum : bool { value = true };
+        // object in place, nullptr if not value of bound class
+        static auto get(mrb_state* mrb, const mrb_value& v) noexcept -> T* {
+            if (mrb_type(v) != MRB_TT_ISTRUCT) return nullptr;
+            const auto cla = state_context::get(mrb).get_class<T>();
+            const auto same = cla && (::mrb_obj_class(mrb, v) == cla || ::mrb_obj_is_kind_of(mrb, v, cla));
+            return same ? reinterpret_cast<T*>(ISTRUCT_PTR(v)) : nullptr;
+        }
+        // new ruby object with copy of object
+        static auto set(mrb_state* mrb, RClass* cla, const T& obj) noexcept {
+            const auto v = ::mrb_obj_value(::mrb_obj_alloc(mrb, MRB_TT_ISTRUCT, cla));
+            std::memcpy(ISTRUCT_PTR(v), &obj, sizeof(T));
+            return v;
+        }
+    };
+    // object of receiver, in place for value type
+    template<typename T> static inline auto object_of(const mrb_value& self) noexcept -> T* {
+        if (value_helper<T>::value && mrb_type(self) == MRB_TT_ISTRUCT) return reinterpret_cast<T*>(ISTRUCT_PTR(self));
+        return static_cast<T*>(DATA_PTR(self));
+    }
+    // object helper, wrap object of bound class with identity
+    template<typename T> struct object_helper {
+        // object of T or nullptr, in place for value type
+        static auto get(mrb_state* mrb, const mrb_value& v) noexcept -> T* {
+            if (mrb_type(v) != MRB_TT_DATA) return value_helper<T>::get(mrb, v);
+            const auto type = DATA_TYPE(v);
+            return (type == &data_type_helper<T>::get_type() || type == &data_type_helper<T>::get_borrowed_type()
+                || type == &slab_pool<T>::get_type()) ? static_cast<T*>(DATA_PTR(v)) : nullptr;
+        }
+        // add wrapper created by ruby to identity map once its object is given to c++, borrowed one is linked already
+        static void link(mrb_state* mrb, const mrb_value& v) noexcept {
+            if (mrb_type(v) != MRB_TT_DATA || DATA_TYPE(v) == &data_type_helper<T>::get_borrowed_type()) return;
+            auto& ctx = state_context::get(mrb);
+            if (!ctx.find_object<T>(DATA_PTR(v))) ctx.link_object<T>(mrb, RDATA(v), true);
+        }
+        // link wrapper created by ruby at once if its native size or values are tracked by gc
+        static void track(mrb_state* mrb, mrb_value self) noexcept {
+            auto& ctx = state_context::get(mrb);
+            if (DATA_PTR(self) && ctx.has_gc<T>()) ctx.link_object<T>(mrb, RDATA(self), true);
+        }
+        // wrap object, same wrapper if alive, owned one takes the ownership
+        static auto wrap(mrb_state* mrb, T* ptr, bool own) noexcept {
+            if (!ptr) return ::mrb_nil_value();
+            auto& ctx = state_context::get(mrb);
+            const auto cla = ctx.get_class<T>();
+            assert(cla && "class not bound in this state");
+            // value type is copied, no identity
+            if (value_helper<T>::value && MRB_INSTANCE_TT(cla) == MRB_TT_ISTRUCT) {
+                const auto v = value_helper<T>::set(mrb, cla, *ptr);
+                if (own) delete ptr;
+                return v;
+            }
+            auto type = own ? &data_type_helper<T>::get_type() : &data_type_helper<T>::get_borrowed_type();
+            if (const auto data = ctx.find_object<T>(ptr)) {
+                if (!::mrb_object_dead_p(mrb, reinterpret_cast<RBasic*>(data))) {
+                    if (own && data->type == &data_type_helper<T>::get_borrowed_type()) {
+                        data->type = type;
+                        ctx.link_object<T>(mrb, data, true);
+                    }
+                    return ::mrb_obj_value(data);
+                }
+                // wrapper not swept yet, the new one takes its ownership
+                if (data->type != &data_type_helper<T>::get_borrowed_type()) type = data->type;
+                data->data = nullptr;
+            }
+            else if (const auto self = object_helper::receiver(mrb, ptr)) {
+                // receiver returned by its own method, created by ruby and not linked yet
+                ctx.link_object<T>(mrb, self, true);
+                return ::mrb_obj_value(self);
+            }
+            const auto data = ::mrb_data_object_alloc(mrb, cla, ptr, type);
+            ctx.link_object<T>(mrb, data, type != &data_type_helper<T>::get_borrowed_type());
+            return ::mrb_obj_value(data);
+        }
+    private:
+        // receiver of current call if it wraps the object, nullptr otherwise
+        static auto receiver(mrb_state* mrb, const T* ptr) noexcept -> RData* {
+            if (!mrb->c->stack) return nullptr;
+            const auto& self = mrb->c->stack[0];
+            return mrb_type(self) == MRB_TT_DATA && DATA_PTR(self) == ptr && object_helper::get(mrb, self) ? RDATA(self) : nullptr;
+        }
     };
+    // note new binding of state, return extra pointer stored in env[1] of method
+    static inline void* attach_binding(mrb_state* mrb, RClass* cla, const char* name, bool singleton) noexcept {
+        state_context::get(mrb).add_binding(::mrb_class_name(mrb, cla), name, singleton);
+        return profile_probe::attach(mrb, cla, name, singleton);
+    }
+    // helper for data object alloc
+    template<typename T> 
+    auto mrb_data_object_alloc_helper(mrb_state* ms, void*data) noexcept {
+        return ::mrb_data_object_alloc(ms, 
+            state_context::get(ms).get_class<T>(),
+            data,
+            &data_type_helper<T>::get_type()
+        );
+    }
     // type helper for pointer type to obj type
     template<typename T> struct type_helper_ptr { using type = T; };
     // type helper for pointer type to obj type
     template<typename T> struct type_helper_ptr<T*> { using type = typename type_helper_ptr<T>::type; };
     // ruby binder
-    static inline auto ruby_binder() noexcept { assert(!"bad overload"); return 0ui32; };
+    static inline auto ruby_binder() noexcept { assert(!"bad overload"); return 0u; };
+    // ruby arg to c++: for bound class by value, value_class<T> given only, no ruby_arg for other types
+    template<typename T, bool = std::is_class<T>::value && value_class<T>::value> struct value_arg { };
+    // ruby arg to c++: for bound class by value, copied
+    template<typename T> struct value_arg<T, true> {
+        // type mask
+        enum : uint32_t { mask = type_bit(MRB_TT_ISTRUCT) | type_bit(MRB_TT_DATA) };
+        // object of the bound class
+        static bool accept(mrb_state* mrb, const mrb_value& v) noexcept { return object_helper<T>::get(mrb, v) != nullptr; }
+        // raise TypeError for value not accepted
+        static void raise(mrb_state* mrb, const mrb_value& v) noexcept {
+            raise_helper::raisevalue(mrb, v, state_context::get(mrb).get_class<T>());
+        }
+        // get with mruby state
+        static auto get(mrb_state* mrb, const mrb_value& v) noexcept -> T {
+            const auto obj = object_helper<T>::get(mrb, v);
+            if (!obj) value_arg::raise(mrb, v);
+            return *obj;
+        }
+        // set mruby, inline for value class, heap copy owned by ruby otherwise
+        template<typename Lam>
+        static auto set(mrb_state* ms, Lam lam, const mrb_value* /*arg*/) noexcept { 
+            const T obj = lam();
+            const auto cla = state_context::get(ms).get_class<T>();
+            assert(cla && "class not bound in this state");
+            if (MRB_INSTANCE_TT(cla) == MRB_TT_ISTRUCT) return value_helper<T>::set(ms, cla, obj);
+            return object_helper<T>::wrap(ms, new(std::nothrow) T(obj), true);
+        }
+    };
     // ruby arg to c++
-    template<typename T> struct ruby_arg { };
+    template<typename T> struct ruby_arg : value_arg<T> { };
     // ruby arg to c++: for void
     template<> struct ruby_arg<void> {
         // get mruby
@@ -140,6 +1324,8 @@ namespace BindER {
     };
     // ruby arg to c++: for bool
     template<> struct ruby_arg<bool> {
+        // type mask in overload set, any type for single method
+        enum : uint32_t { overload_mask = type_bit(MRB_TT_TRUE) | type_bit(MRB_TT_FALSE) };
         // get mruby
         static auto get(const mrb_value& v) noexcept { return mrb_test(v); }
         // set mruby
@@ -150,6 +1336,8 @@ namespace BindER {
     };
     // mruby arg to c++: for float
     template<> struct ruby_arg<float> {
+        // type mask
+        enum : uint32_t { mask = type_number };
         // get
         static auto get(const mrb_value& v) noexcept { 
             return mrb_float_p(v) ? static_cast<float>(mrb_float(v)) : static_cast<float>(mrb_fixnum(v)); 
@@ -162,6 +1350,8 @@ namespace BindER {
     };
     // mruby arg to c++: for float
     template<> struct ruby_arg<double> {
+        // type mask
+        enum : uint32_t { mask = type_number };
         // get
         static auto get(const mrb_value& v) noexcept { 
             return mrb_float_p(v) ? static_cast<double>(mrb_float(v)) : static_cast<double>(mrb_fixnum(v)); 
@@ -174,6 +1364,10 @@ namespace BindER {
     };
     // mruby arg to c++: for int32_t
     template<> struct ruby_arg<int32_t> {
+        // type mask
+        enum : uint32_t { mask = type_number };
+        // type mask in overload set, float is not truncated
+        enum : uint32_t { overload_mask = type_bit(MRB_TT_FIXNUM) };
         // get
         static auto get(const mrb_value& v) noexcept { 
             return mrb_fixnum_p(v) ?  static_cast<int32_t>(mrb_fixnum(v)) : static_cast<int32_t>(mrb_float(v)); 
@@ -186,6 +1380,10 @@ namespace BindER {
     };
     // mruby arg to c++: for uint32_t
     template<> struct ruby_arg<uint32_t> {
+        // type mask
+        enum : uint32_t { mask = type_number };
+        // type mask in overload set, float is not truncated
+        enum : uint32_t { overload_mask = type_bit(MRB_TT_FIXNUM) };
         // get
         static auto get(const mrb_value& v) noexcept { 
             return mrb_fixnum_p(v) ?  static_cast<uint32_t>(mrb_fixnum(v)) : static_cast<uint32_t>(mrb_float(v)); 
@@ -198,6 +1396,8 @@ namespace BindER {
     };
     // mruby arg to c++: for const char*
     template<> struct ruby_arg<const char*> {
+        // type mask
+        enum : uint32_t { mask = type_bit(MRB_TT_STRING) };
         // get
         static auto get(const mrb_value& v) noexcept { return RSTRING_PTR(v); }
         // set mruby
@@ -206,8 +1406,25 @@ namespace BindER {
             return ::mrb_str_new_cstr(ms, lam());
         }
     };
+    // mruby arg to c++: for std::string, copied
+    template<> struct ruby_arg<std::string> {
+        // type mask
+        enum : uint32_t { mask = type_bit(MRB_TT_STRING) };
+        // get
+        static auto get(const mrb_value& v) noexcept { return std::string(RSTRING_PTR(v), size_t(RSTRING_LEN(v))); }
+        // set mruby
+        template<typename Lam>
+        static auto set(mrb_state* ms, Lam lam, const mrb_value* /*arg*/) noexcept { 
+            const auto& str = lam();
+            return ::mrb_str_new(ms, str.data(), str.size());
+        }
+    };
+    // mruby arg to c++: for const std::string&, copied
+    template<> struct ruby_arg<const std::string&> : ruby_arg<std::string> { };
     // mruby arg to c++: for void*
     template<> struct ruby_arg<void*> {
+        // type mask
+        enum : uint32_t { mask = type_bit(MRB_TT_CPTR) };
         // get
         static auto get(const mrb_value& v) noexcept { return mrb_cptr(v); }
         // set mruby
@@ -216,123 +1433,1678 @@ namespace BindER {
             return ::mrb_cptr_value(ms, lam());
         }
     };
-    // mruby arg to c++: for void*
-    template<size_t id> struct ruby_arg<original_parameter<id>> {
+    // mruby arg to c++: for byte span, borrow buffer of string
+    template<> struct ruby_arg<span<const char>> {
+        // type mask
+        enum : uint32_t { mask = type_bit(MRB_TT_STRING) };
         // get
-        static auto get(const mrb_value& v) noexcept { static_assert(false, "error"); }
-        // set mruby
+        static auto get(const mrb_value& v) noexcept { 
+            return span<const char>{ RSTRING_PTR(v), size_t(RSTRING_LEN(v)) };
+        }
+        // set mruby
+        template<typename Lam>
+        static auto set(mrb_state* ms, Lam lam, const mrb_value* /*arg*/) noexcept { 
+            const auto bytes = lam();
+            return ::mrb_str_new(ms, bytes.data, bytes.size);
+        }
+    };
+    // mruby arg to c++: for byte span, borrow buffer of string
+    template<> struct ruby_arg<span<const uint8_t>> {
+        // type mask
+        enum : uint32_t { mask = type_bit(MRB_TT_STRING) };
+        // get
+        static auto get(const mrb_value& v) noexcept { 
+            return span<const uint8_t>{ reinterpret_cast<const uint8_t*>(RSTRING_PTR(v)), size_t(RSTRING_LEN(v)) };
+        }
+        // set mruby
+        template<typename Lam>
+        static auto set(mrb_state* ms, Lam lam, const mrb_value* /*arg*/) noexcept { 
+            const auto bytes = lam();
+            return ::mrb_str_new(ms, reinterpret_cast<const char*>(bytes.data), bytes.size);
+        }
+    };
+    // mruby arg to c++: for static string, wrap without copy
+    template<> struct ruby_arg<static_string> {
+        // type mask
+        enum : uint32_t { mask = type_bit(MRB_TT_STRING) };
+        // get
+        static auto get(const mrb_value& v) noexcept { 
+            return static_string(RSTRING_PTR(v), size_t(RSTRING_LEN(v)));
+        }
+        // set mruby
+        template<typename Lam>
+        static auto set(mrb_state* ms, Lam lam, const mrb_value* /*arg*/) noexcept { 
+            const auto str = lam();
+            return ::mrb_str_new_static(ms, str.data, str.size);
+        }
+    };
+#ifdef BINDER_RUBY_STRING_VIEW
+    // mruby arg to c++: for std::string_view, borrow buffer of string
+    template<> struct ruby_arg<std::string_view> {
+        // type mask
+        enum : uint32_t { mask = type_bit(MRB_TT_STRING) };
+        // get
+        static auto get(const mrb_value& v) noexcept { 
+            return std::string_view(RSTRING_PTR(v), size_t(RSTRING_LEN(v)));
+        }
+        // set mruby
+        template<typename Lam>
+        static auto set(mrb_state* ms, Lam lam, const mrb_value* /*arg*/) noexcept { 
+            const auto str = lam();
+            return ::mrb_str_new(ms, str.data(), str.size());
+        }
+    };
+#endif
+    // integer type whose every value fits in mrb_int
+    template<typename T, bool = std::is_integral<T>::value> struct fits_int : std::false_type {};
+    // integer type whose every value fits in mrb_int
+    template<typename T> struct fits_int<T, true> : std::integral_constant<bool,
+        uintmax_t(std::numeric_limits<T>::max()) <= uintmax_t(MRB_INT_MAX)
+        && intmax_t(std::numeric_limits<T>::min()) >= intmax_t(MRB_INT_MIN)> {};
+    // array helper, conversion between ruby array and c++ numbers,
+    // scalar loops with a branch-free path for homogeneous arrays
+    struct array_helper {
+        // test type of every value, one scalar pass without early exit
+        static bool all_of(const mrb_value* src, size_t n, mrb_vtype tt) noexcept {
+            bool same = true;
+            for (size_t i = 0; i != n; ++i) same &= mrb_type(src[i]) == tt;
+            return same;
+        }
+        // index of first element not matching T, -1 if none
+        template<typename T, bool Overload = false> 
+        static mrb_int mismatch(const mrb_value& v) noexcept {
+            // masks of overload set: integers match fixnum only
+            constexpr uint32_t mask = Overload ? uint32_t(overload_mask_helper<T>::value) : uint32_t(mask_helper<T>::value);
+            const auto src = RARRAY_PTR(v);
+            const auto n = RARRAY_LEN(v);
+            for (mrb_int i = 0; i != n; ++i) {
+                if (!(mask & type_bit(mrb_type(src[i])))) return i;
+                if ((Overload ? arg_checker<T>::overload_mismatch(src[i]) : arg_checker<T>::mismatch(src[i])) >= 0) return i;
+            }
+            return -1;
+        }
+        // unbox numbers, non-number element -> 0 if not checked
+        template<typename T> 
+        static void unbox(const mrb_value* src, size_t n, T* out) noexcept {
+            // homogeneous: one tight loop without branch on value type
+            if (array_helper::all_of(src, n, MRB_TT_FIXNUM)) {
+                for (size_t i = 0; i != n; ++i) out[i] = static_cast<T>(mrb_fixnum(src[i]));
+            }
+            else if (array_helper::all_of(src, n, MRB_TT_FLOAT)) {
+                for (size_t i = 0; i != n; ++i) out[i] = static_cast<T>(mrb_float(src[i]));
+            }
+            // mixed
+            else for (size_t i = 0; i != n; ++i) {
+                const auto& v = src[i];
+                out[i] = mrb_fixnum_p(v) ? static_cast<T>(mrb_fixnum(v)) 
+                    : (mrb_float_p(v) ? static_cast<T>(mrb_float(v)) : T(0));
+            }
+        }
+        // box one number, integer out of mrb_int range -> float as ruby does
+        template<typename T> 
+        static auto box(mrb_state* mrb, T v) noexcept {
+            return array_helper::fits(v, fits_int<T>()) ?
+                ::mrb_fixnum_value(static_cast<mrb_int>(v)) :
+                ::mrb_float_value(mrb, static_cast<mrb_float>(v));
+        }
+        // every value of type fits
+        template<typename T> static bool fits(T, std::true_type) noexcept { return true; }
+        // integer in range of mrb_int, never for floating point
+        template<typename T> static bool fits(T v, std::false_type) noexcept {
+            return array_helper::in_range(v, std::is_integral<T>(), std::is_signed<T>());
+        }
+        // floating point
+        template<typename T, typename S> static bool in_range(T, std::false_type, S) noexcept { return false; }
+        // signed integer
+        template<typename T> static bool in_range(T v, std::true_type, std::true_type) noexcept { 
+            return intmax_t(v) >= intmax_t(MRB_INT_MIN) && intmax_t(v) <= intmax_t(MRB_INT_MAX); 
+        }
+        // unsigned integer
+        template<typename T> static bool in_range(T v, std::true_type, std::false_type) noexcept { 
+            return uintmax_t(v) <= uintmax_t(MRB_INT_MAX); 
+        }
+        // box numbers to new array
+        template<typename T> 
+        static auto box(mrb_state* mrb, const T* src, size_t n) noexcept {
+            auto ary = ::mrb_ary_new_capa(mrb, mrb_int(n));
+#ifdef MRB_WORD_BOXING
+            // float is heap object with word boxing, also for integer out of range
+            if (!fits_int<T>::value) {
+                const auto ai = ::mrb_gc_arena_save(mrb);
+                for (size_t i = 0; i != n; ++i) {
+                    ::mrb_ary_push(mrb, ary, array_helper::box(mrb, src[i]));
+                    ::mrb_gc_arena_restore(mrb, ai);
+                }
+                return ary;
+            }
+#endif
+            // immediate value: fill the buffer directly
+            ::mrb_ary_resize(mrb, ary, mrb_int(n));
+            const auto dst = const_cast<mrb_value*>(RARRAY_PTR(ary));
+            for (size_t i = 0; i != n; ++i) dst[i] = array_helper::box(mrb, src[i]);
+            return ary;
+        }
+    };
+    // mruby arg to c++: for std::vector
+    template<typename T> struct ruby_arg<std::vector<T>> {
+        // type mask
+        enum : uint32_t { mask = type_bit(MRB_TT_ARRAY) };
+        // bulk conversion for numbers
+        enum : bool { bulk = std::is_arithmetic<T>::value && !std::is_same<T, bool>::value };
+        // mismatched element
+        static auto mismatch(const mrb_value& v) noexcept { return array_helper::mismatch<T>(v); }
+        // mismatched element in overload set
+        static auto overload_mismatch(const mrb_value& v) noexcept { return array_helper::mismatch<T, true>(v); }
+        // get
+        static auto get(const mrb_value& v) noexcept { 
+            std::vector<T> vec(size_t(RARRAY_LEN(v)));
+            ruby_arg::unbox(RARRAY_PTR(v), vec, std::integral_constant<bool, bulk>());
+            return vec;
+        }
+        // set mruby
+        template<typename Lam>
+        static auto set(mrb_state* ms, Lam lam, const mrb_value* /*arg*/) noexcept { 
+            const auto vec = lam();
+            return ruby_arg::box(ms, vec, std::integral_constant<bool, bulk>());
+        }
+    private:
+        // unbox numbers
+        static void unbox(const mrb_value* src, std::vector<T>& vec, std::true_type) noexcept {
+            array_helper::unbox(src, vec.size(), vec.data());
+        }
+        // unbox others one by one
+        static void unbox(const mrb_value* src, std::vector<T>& vec, std::false_type) noexcept {
+            for (size_t i = 0; i != vec.size(); ++i) vec[i] = ruby_arg<T>::get(src[i]);
+        }
+        // box numbers
+        static auto box(mrb_state* ms, const std::vector<T>& vec, std::true_type) noexcept {
+            return array_helper::box(ms, vec.data(), vec.size());
+        }
+        // box others one by one
+        static auto box(mrb_state* ms, const std::vector<T>& vec, std::false_type) noexcept {
+            auto ary = ::mrb_ary_new_capa(ms, mrb_int(vec.size()));
+            const auto ai = ::mrb_gc_arena_save(ms);
+            for (const auto& e : vec) {
+                const auto lam = [&e]() noexcept -> const T& { return e; };
+                ::mrb_ary_push(ms, ary, ruby_arg<T>::set(ms, lam, nullptr));
+                ::mrb_gc_arena_restore(ms, ai);
+            }
+            return ary;
+        }
+    };
+    // mruby arg to c++: for const std::vector&, same with std::vector
+    template<typename T> struct ruby_arg<const std::vector<T>&> : ruby_arg<std::vector<T>> { };
+    // mruby arg to c++: for span of numbers, copied to buffer living during the call, not a borrow
+    template<typename T> struct ruby_arg<span<const T>> {
+        static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, "number only");
+        // type mask
+        enum : uint32_t { mask = type_bit(MRB_TT_ARRAY) };
+        // mismatched element
+        static auto mismatch(const mrb_value& v) noexcept { return array_helper::mismatch<T>(v); }
+        // mismatched element in overload set
+        static auto overload_mismatch(const mrb_value& v) noexcept { return array_helper::mismatch<T, true>(v); }
+        // get
+        static auto get(const mrb_value& v) noexcept { 
+            span_buffer<const T> buf;
+            const auto n = size_t(RARRAY_LEN(v));
+            array_helper::unbox(RARRAY_PTR(v), n, buf.resize(n));
+            return buf;
+        }
+        // set mruby
+        template<typename Lam>
+        static auto set(mrb_state* ms, Lam lam, const mrb_value* /*arg*/) noexcept { 
+            const auto numbers = lam();
+            return array_helper::box(ms, numbers.data, numbers.size);
+        }
+    };
+    // mruby arg to c++: for span of numbers, return only
+    template<typename T> struct ruby_arg<span<T>> : ruby_arg<span<const T>> { };
+    // mruby arg to c++: for void*
+    template<size_t id> struct ruby_arg<original_parameter<id>> {
+        // get
+        static auto get(const mrb_value& v) noexcept { static_assert(id != id, "return type only"); }
+        // set mruby
         template<typename Lam>
         static auto set(mrb_state*, Lam lam, const mrb_value* arg) noexcept { 
             lam();  return arg[id];
         }
     };
+    // mruby arg to c++: for pointer of bound class, borrowed, nil for nullptr
+    template<typename T> struct ruby_arg<T*> {
+        static_assert(std::is_class<T>::value, "pointer of bound class only");
+        // object type
+        using object_type = typename std::remove_const<T>::type;
+        // type mask
+        enum : uint32_t { mask = type_bit(MRB_TT_DATA) | type_bit(MRB_TT_ISTRUCT) | type_bit(MRB_TT_FALSE) };
+        // object of the bound class or nil
+        static bool accept(mrb_state* mrb, const mrb_value& v) noexcept { 
+            return mrb_nil_p(v) || object_helper<object_type>::get(mrb, v) != nullptr; 
+        }
+        // raise TypeError for value not accepted
+        static void raise(mrb_state* mrb, const mrb_value& v) noexcept {
+            raise_helper::raisevalue(mrb, v, state_context::get(mrb).get_class<object_type>());
+        }
+        // get with mruby state, linked as c++ may keep it
+        static auto get(mrb_state* mrb, const mrb_value& v) noexcept -> T* { 
+            if (mrb_nil_p(v)) return nullptr;
+            const auto obj = object_helper<object_type>::get(mrb, v);
+            if (!obj) ruby_arg::raise(mrb, v);
+            object_helper<object_type>::link(mrb, v);
+            return obj;
+        }
+        // set mruby
+        template<typename Lam>
+        static auto set(mrb_state* ms, Lam lam, const mrb_value* /*arg*/) noexcept { 
+            return object_helper<object_type>::wrap(ms, const_cast<object_type*>(lam()), false);
+        }
+    };
+    // mruby arg to c++: for reference of bound class, borrowed
+    template<typename T> struct ruby_arg<T&> {
+        static_assert(std::is_class<T>::value, "reference of bound class only");
+        // object type
+        using object_type = typename std::remove_const<T>::type;
+        // type mask
+        enum : uint32_t { mask = type_bit(MRB_TT_DATA) | type_bit(MRB_TT_ISTRUCT) };
+        // object of the bound class
+        static bool accept(mrb_state* mrb, const mrb_value& v) noexcept { return object_helper<object_type>::get(mrb, v) != nullptr; }
+        // raise TypeError for value not accepted
+        static void raise(mrb_state* mrb, const mrb_value& v) noexcept {
+            raise_helper::raisevalue(mrb, v, state_context::get(mrb).get_class<object_type>());
+        }
+        // get with mruby state, in place for value type, linked as c++ may keep it
+        static auto get(mrb_state* mrb, const mrb_value& v) noexcept -> T& { 
+            const auto obj = object_helper<object_type>::get(mrb, v);
+            if (!obj) ruby_arg::raise(mrb, v);
+            object_helper<object_type>::link(mrb, v);
+            return *obj;
+        }
+        // set mruby
+        template<typename Lam>
+        static auto set(mrb_state* ms, Lam lam, const mrb_value* /*arg*/) noexcept { 
+            return object_helper<object_type>::wrap(ms, const_cast<object_type*>(&lam()), false);
+        }
+    };
+    // mruby arg to c++: for object owned by ruby, return type only
+    template<typename T> struct ruby_arg<owned<T>> {
+        // get
+        static auto get(const mrb_value& /*value*/) noexcept { static_assert(sizeof(T) != sizeof(T), "return type only"); }
+        // set mruby
+        template<typename Lam>
+        static auto set(mrb_state* ms, Lam lam, const mrb_value* /*arg*/) noexcept { 
+            return object_helper<T>::wrap(ms, lam().ptr, true);
+        }
+    };
+    // mruby arg to c++: for object owned by c++, return type only
+    template<typename T> struct ruby_arg<borrowed<T>> {
+        // get
+        static auto get(const mrb_value& /*value*/) noexcept { static_assert(sizeof(T) != sizeof(T), "return type only"); }
+        // set mruby
+        template<typename Lam>
+        static auto set(mrb_state* ms, Lam lam, const mrb_value* /*arg*/) noexcept { 
+            return object_helper<T>::wrap(ms, lam().ptr, false);
+        }
+    };
+    // callback helper, call ruby from c++
+    struct callback_helper {
+        // box one argument by ruby_arg<T>::set
+        template<typename T, typename Arg> 
+        static auto box(mrb_state* mrb, Arg& arg) noexcept {
+            return ruby_arg<T>::set(mrb, [&arg]() noexcept -> decltype(auto) { return static_cast<T>(arg); }, nullptr);
+        }
+        // unbox result, value-initialized if type mismatched or raised with mrb->exc kept(top level only)
+        template<typename R> 
+        static auto unbox(mrb_state* mrb, const mrb_value& v) noexcept {
+            static_assert(!std::is_reference<R>::value, "reference result not supported");
+            using result_type = typename std::decay<decltype(arg_getter<R>::get(mrb, v))>::type;
+            if (mrb->exc || !(mask_helper<R>::value & type_bit(mrb_type(v))) || arg_checker<R>::mismatch(v) >= 0 
+                || !object_checker<R>::accept(mrb, v)) return result_type();
+            return result_type(arg_getter<R>::get(mrb, v));
+        }
+        // call proc with self, cfunc or missing method by mrb_funcall_argv for its protection
+        static auto call(mrb_state* mrb, RProc* proc, mrb_value self, RClass* cla, mrb_sym mid, mrb_int argc, const mrb_value* argv) noexcept {
+            if (proc && !MRB_PROC_CFUNC_P(proc)) return ::mrb_yield_with_class(mrb, ::mrb_obj_value(proc), argc, argv, self, cla);
+            return ::mrb_funcall_argv(mrb, self, mid, argc, argv);
+        }
+        // invoke with arguments of c++, arena restored after the result unboxed
+        template<typename R, typename... Args, typename... Values>
+        static auto invoke(mrb_state* mrb, RProc* proc, mrb_value self, RClass* cla, mrb_sym mid, Values&... args) noexcept {
+            const auto ai = ::mrb_gc_arena_save(mrb);
+            const mrb_value argv[sizeof...(Args) + 1] = { callback_helper::box<Args>(mrb, args)..., ::mrb_nil_value() };
+            const auto value = callback_helper::call(mrb, proc, self, cla, mid, mrb_int(sizeof...(Args)), argv);
+            return callback_helper::finish<R>(mrb, value, ai, std::is_void<R>());
+        }
+    private:
+        // finish with result
+        template<typename R> static auto finish(mrb_state* mrb, const mrb_value& value, int ai, std::false_type) noexcept {
+            const auto result = callback_helper::unbox<R>(mrb, value);
+            ::mrb_gc_arena_restore(mrb, ai);
+            return result;
+        }
+        // finish without result
+        template<typename R> static void finish(mrb_state* mrb, const mrb_value&, int ai, std::true_type) noexcept {
+            ::mrb_gc_arena_restore(mrb, ai);
+        }
+    };
+    // frame helper, a method entered by mrb_yield_with_class runs in a frame named by its caller
+    struct frame_helper {
+        // method or its blocks use super or __method__, it is called by name then
+        static bool needs_frame(mrb_state* mrb, const mrb_irep* irep) noexcept {
+            const auto name = mrb_intern_lit(mrb, "__method__");
+            for (size_t i = 0; i != irep->ilen; ++i) if (GET_OPCODE(irep->iseq[i]) == OP_SUPER) return true;
+            for (size_t i = 0; i != irep->slen; ++i) if (irep->syms[i] == name) return true;
+            for (size_t i = 0; i != irep->rlen; ++i) if (frame_helper::needs_frame(mrb, irep->reps[i])) return true;
+            return false;
+        }
+    };
+    // ruby proc as c++ invocable, valid during the bound call only
+    template<typename Sig> class ruby_proc;
+    // ruby proc as c++ invocable, valid during the bound call only
+    template<typename R, typename... Args> class ruby_proc<R(Args...)> {
+    public:
+        // ctor
+        ruby_proc(mrb_state* mrb, const mrb_value& proc) noexcept : mrb(mrb), proc(proc) {}
+        // call, always inside the bound call: a raise longjmps through the c++ frames to the nearest rescue
+        auto operator()(Args... args) const noexcept {
+            // cfunc proc called by Proc#call on itself
+            const auto p = mrb_proc_ptr(proc);
+            if (MRB_PROC_CFUNC_P(p)) 
+                return callback_helper::invoke<R, Args...>(mrb, nullptr, proc, nullptr, state_context::get(mrb).get_call_sym(mrb), args...);
+            // name not used by ruby proc
+            const auto self = p->env ? p->env->stack[0] : ::mrb_top_self(mrb);
+            return callback_helper::invoke<R, Args...>(mrb, p, self, p->target_class, mrb_sym(0), args...);
+        }
+        // nil given or not
+        explicit operator bool() const noexcept { return mrb_type(proc) == MRB_TT_PROC; }
+        // get value
+        auto get_value() const noexcept { return proc; }
+    private:
+        // mruby state
+        mrb_state*      mrb;
+        // proc
+        mrb_value       proc;
+    };
+    // mruby arg to c++: for ruby proc, nil for empty one
+    template<typename Sig> struct ruby_arg<ruby_proc<Sig>> {
+        // type mask
+        enum : uint32_t { mask = type_bit(MRB_TT_PROC) | type_bit(MRB_TT_FALSE) };
+        // get with mruby state
+        static auto get(mrb_state* mrb, const mrb_value& v) noexcept { return ruby_proc<Sig>(mrb, v); }
+        // set mruby
+        template<typename Lam>
+        static auto set(mrb_state*, Lam lam, const mrb_value* /*arg*/) noexcept { return lam().get_value(); }
+    };
     // -----------------------------------
     //      ADD YOUR OWN TYPE HERE        
     // -----------------------------------
-    // mruby binder
-    class mruby_binder {
+    // signature helper, check ruby arguments by type masks from type_helper
+    template<typename TypeHelper, size_t Offset, typename = std::make_index_sequence<TypeHelper::arity - Offset>> 
+    struct signature_helper;
+    // signature helper
+    template<typename TypeHelper, size_t Offset, size_t... Index> 
+    struct signature_helper<TypeHelper, Offset, std::index_sequence<Index...>> {
+        // count of ruby arguments
+        enum : size_t { count = sizeof...(Index) };
+        // get masks
+        static auto masks() noexcept -> const uint32_t* {
+            static const uint32_t list[count + 1] = { 
+                mask_helper<typename TypeHelper::template arg<Offset + Index>::type>::value..., 0 
+            };
+            return list;
+        }
+        // get masks in overload set
+        static auto overload_masks() noexcept -> const uint32_t* {
+            static const uint32_t list[count + 1] = { 
+                overload_mask_helper<typename TypeHelper::template arg<Offset + Index>::type>::value..., 0 
+            };
+            return list;
+        }
+        // match in one pass, return index of first mismatched argument or count
+        static size_t match(const mrb_value* args, const uint32_t* list = signature_helper::masks()) noexcept {
+            for (size_t i = 0; i != count; ++i) if (!(list[i] & type_bit(mrb_type(args[i])))) return i;
+            return count;
+        }
+        // match in overload set: masks, then elements of arrays and classes of objects, nothing raised
+        static bool accept(mrb_state* mrb, const mrb_value* args) noexcept {
+            (void)mrb;
+            if (signature_helper::match(args, signature_helper::overload_masks()) != count) return false;
+            const bool elements[] = { 
+                (arg_checker<typename TypeHelper::template arg<Offset + Index>::type>::overload_mismatch(args[Index]) < 0)..., true 
+            };
+            const bool objects[] = { 
+                object_checker<typename TypeHelper::template arg<Offset + Index>::type>::accept(mrb, args[Index])..., true 
+            };
+            for (size_t i = 0; i != count; ++i) if (!elements[i] || !objects[i]) return false;
+            return true;
+        }
+        // check arguments, raise TypeError if mismatched
+        static void check(mrb_state* mrb, const mrb_value* args) noexcept {
+#ifdef BINDER_RUBY_TYPE_CHECK
+            const auto index = signature_helper::match(args);
+            if (index != count) raise_helper::raisetype(mrb, args[index], index);
+            // elements of arrays, before any conversion
+            (void)std::initializer_list<int>{ 
+                (arg_checker<typename TypeHelper::template arg<Offset + Index>::type>::check(mrb, args[Index]), 0)..., 0 
+            };
+            // objects of bound classes
+            (void)std::initializer_list<int>{ 
+                (object_checker<typename TypeHelper::template arg<Offset + Index>::type>::check(mrb, args[Index]), 0)..., 0 
+            };
+#else
+            (void)mrb; (void)args;
+#endif
+        }
+    };
+    // invoke helper, call c++ function with ruby arguments
+    template<typename CppClass, size_t Offset> struct invoke_helper;
+    // invoke helper: [rb]class-method call [cpp]static-class-function
+    template<typename CppClass> struct invoke_helper<CppClass, 0> {
+        // call, traits from type of bound callable
+        template<typename Traits, typename T>
+        static auto call(mrb_state* mrb, mrb_value self, const T& real_method, mrb_value* args) noexcept {
+            (void)self;
+            using traits = Traits;
+            // no arg call
+            auto no_arg_lambda = [mrb, &real_method, args]() noexcept -> decltype(auto) {
+                return call_helper<traits::arity>::template call<traits>(mrb, real_method, args);
+            };
+            return ruby_arg<typename traits::result_type>::set(mrb, no_arg_lambda, args);
+        }
+        // call and drop the result without boxing
+        template<typename Traits, typename T>
+        static void discard(mrb_state* mrb, mrb_value, const T& real_method, mrb_value* args) noexcept {
+            call_helper<Traits::arity>::template call<Traits>(mrb, real_method, args);
+        }
+    };
+    // invoke helper: [rb]instance-method call [cpp]member-function, first arg is object-ptr
+    template<typename CppClass> struct invoke_helper<CppClass, 1> {
+        // call, traits from type of bound callable
+        template<typename Traits, typename T>
+        static auto call(mrb_state* mrb, mrb_value self, const T& real_method, mrb_value* args) noexcept {
+            using traits = Traits;
+            auto obj = object_of<CppClass>(self);
+            // no arg call
+            auto no_arg_lambda = [mrb, &real_method, args, obj]() noexcept -> decltype(auto) {
+                return call_helper<traits::arity - 1>::template call<traits>(mrb, real_method, args - 1, obj);
+            };
+            return ruby_arg<typename traits::result_type>::set(mrb, no_arg_lambda, args);
+        }
+        // call and drop the result without boxing
+        template<typename Traits, typename T>
+        static void discard(mrb_state* mrb, mrb_value self, const T& real_method, mrb_value* args) noexcept {
+            call_helper<Traits::arity - 1>::template call<Traits>(mrb, real_method, args - 1, object_of<CppClass>(self));
+        }
+    };
+    // overload set, the first one matching arity and argument types is selected, with per-call-site cache
+    template<typename CppClass, size_t Offset, typename... T> class overload_set {
+        // invoker
+        using invoker = mrb_value(*)(mrb_state*, mrb_value, const overload_set&, mrb_value*, profile_probe&);
+        // matcher
+        using matcher = bool(*)(mrb_state*, const mrb_value*, int);
+        // signature of one overload: count and masks
+        struct signature_info { size_t count; const uint32_t* masks; };
+        // overload not overlapping any earlier one, selected whenever matched
+        struct exclusive_table { bool value[sizeof...(T)]; };
+        // cache entry
+        struct cache_entry { const void* site; size_t index; };
+        // size of cache
+        enum : size_t { CACHE_SIZE = 8 };
     public:
-        // class binder
-        template<typename CppClass>
-        class class_binder {
-            // method helper
-            template<size_t ArgNum> struct method_helper {
-                // bind
-                template<typename T> 
-                static inline auto bind(const class_binder<CppClass>& binder, const char* method_name, T method) noexcept {
-                    return method_helper_ex<type_helper<T>::arg<0>::type>::bind(binder, method_name, method);
+        // ctor
+        overload_set(const T&... methods) noexcept : methods(methods...) {}
+        // call
+        auto call(mrb_state* mrb, mrb_value self, mrb_value* args, int narg, profile_probe& probe) const noexcept {
+            // return address of caller identifies the call site
+            const auto site = static_cast<const void*>(mrb->c->ci->pc);
+            auto& entry = cache[(reinterpret_cast<uintptr_t>(site) / sizeof(mrb_code)) % CACHE_SIZE];
+            auto index = entry.index;
+            // monomorphic call site: check the cached one only, if no earlier one could match
+            if (entry.site != site || !overload_set::exclusives().value[index] || !overload_set::matchers()[index](mrb, args, narg)) {
+                for (index = 0; index != sizeof...(T); ++index) {
+                    if (overload_set::matchers()[index](mrb, args, narg)) break;
                 }
-            };
-            // method helper for zero arg
-            template<> struct method_helper<0> {
-                // bind
-                template<typename T> 
-                static inline auto bind(const class_binder<CppClass>& binder, const char* method_name, T method) noexcept {
-                    // no-arg -> [rb]class-method call [cpp]static-class-function
-                    // real ctor lambda to avoid capture
-                    static const auto real_method(method);
-                    // define
-                    ::mrb_define_class_method(binder.get_mruby(), binder.get_class(), method_name, [](mrb_state* mrb, mrb_value self) noexcept {
-                        (void)self;
-                        return ruby_arg<type_helper<T>::result_type>::set(mrb, real_method, nullptr);
-                    }, MRB_ARGS_NONE());
+                if (index == sizeof...(T)) {
+                    ::mrb_raisef(mrb, E_ARGUMENT_ERROR, "no overload of '%S' matches arguments",
+                        ::mrb_symbol_value(mrb->c->ci->mid)
+                    );
+                }
+                entry.site = site;
+                entry.index = index;
+            }
+            return overload_set::invokers()[index](mrb, self, *this, args, probe);
+        }
+    private:
+        // match
+        template<size_t I> static bool match(mrb_state* mrb, const mrb_value* args, int narg) noexcept {
+            using traits = type_helper<typename std::tuple_element<I, std::tuple<T...>>::type>;
+            using signature = signature_helper<traits, Offset>;
+            return narg == int(signature::count) && signature::accept(mrb, args);
+        }
+        // signature
+        template<size_t I> static auto signature() noexcept {
+            using traits = type_helper<typename std::tuple_element<I, std::tuple<T...>>::type>;
+            using signature = signature_helper<traits, Offset>;
+            return signature_info{ signature::count, signature::overload_masks() };
+        }
+        // make table, exclusive if every earlier one differs in arity or in one argument without common type
+        template<size_t... I> static auto exclusives(std::index_sequence<I...>) noexcept {
+            const signature_info list[] = { overload_set::signature<I>()... };
+            exclusive_table table;
+            for (size_t j = 0; j != sizeof...(T); ++j) {
+                table.value[j] = true;
+                for (size_t i = 0; i != j; ++i) {
+                    if (list[i].count != list[j].count) continue;
+                    bool disjoint = false;
+                    for (size_t k = 0; k != list[j].count; ++k) disjoint |= !(list[i].masks[k] & list[j].masks[k]);
+                    if (!disjoint) table.value[j] = false;
+                }
+            }
+            return table;
+        }
+        // invoke
+        template<size_t I> static auto invoke(mrb_state* mrb, mrb_value self, const overload_set& set, mrb_value* args, profile_probe& probe) noexcept {
+            using traits = type_helper<typename std::tuple_element<I, std::tuple<T...>>::type>;
+            signature_helper<traits, Offset>::check(mrb, args);
+            return invoke_helper<CppClass, Offset>::template call<traits>(mrb, self, probe.wrap(std::get<I>(set.methods)), args);
+        }
+        // make table
+        template<size_t... I> static auto matchers(std::index_sequence<I...>) noexcept -> const matcher* {
+            static const matcher table[] = { &overload_set::match<I>... };
+            return table;
+        }
+        // make table
+        template<size_t... I> static auto invokers(std::index_sequence<I...>) noexcept -> const invoker* {
+            static const invoker table[] = { &overload_set::invoke<I>... };
+            return table;
+        }
+        // get matchers
+        static auto matchers() noexcept { return overload_set::matchers(std::index_sequence_for<T...>()); }
+        // get invokers
+        static auto invokers() noexcept { return overload_set::invokers(std::index_sequence_for<T...>()); }
+        // get exclusives
+        static auto& exclusives() noexcept { 
+            static const auto table = overload_set::exclusives(std::index_sequence_for<T...>());
+            return table;
+        }
+    private:
+        // methods
+        std::tuple<T...>            methods;
+        // cache of call sites
+        mutable cache_entry         cache[CACHE_SIZE] = {};
+    };
+    // field helper, get/set field by member pointer
+    template<typename CppClass, typename T> struct field_helper {
+        // member pointer
+        using member_type = T CppClass::*;
+        static_assert(sizeof(member_type) <= sizeof(field_entry::member), "member pointer too large");
+        // make entry
+        static auto make(mrb_sym name, member_type member) noexcept {
+            field_entry entry;
+            entry.name = name;
+            entry.get = &field_helper::get;
+            entry.set = field_helper::get_setter(std::is_const<T>());
+            std::memcpy(entry.member, &member, sizeof(member));
+            return entry;
+        }
+        // get field
+        static auto get(mrb_state* mrb, const CppClass* obj, member_type member) noexcept {
+            return ruby_arg<typename std::remove_const<T>::type>::set(mrb, [obj, member]() noexcept { return obj->*member; }, nullptr);
+        }
+        // set field, false if type mismatched
+        static bool set(mrb_state* mrb, CppClass* obj, member_type member, const mrb_value& value) noexcept {
+#ifdef BINDER_RUBY_TYPE_CHECK
+            if (!(mask_helper<T>::value & type_bit(mrb_type(value))) || arg_checker<T>::mismatch(value) >= 0 
+                || !object_checker<T>::accept(mrb, value)) return false;
+#endif
+            obj->*member = arg_getter<T>::get(mrb, value);
+            return true;
+        }
+    private:
+        // member pointer of entry
+        static auto member_of(const field_entry& entry) noexcept {
+            member_type member;
+            std::memcpy(&member, entry.member, sizeof(member));
+            return member;
+        }
+        // get field, type erased
+        static mrb_value get(mrb_state* mrb, const void* obj, const field_entry& entry) noexcept {
+            return field_helper::get(mrb, static_cast<const CppClass*>(obj), field_helper::member_of(entry));
+        }
+        // set field, type erased
+        static bool set(mrb_state* mrb, void* obj, const field_entry& entry, const mrb_value& value) noexcept {
+            return field_helper::set(mrb, static_cast<CppClass*>(obj), field_helper::member_of(entry), value);
+        }
+        // setter of mutable field
+        static auto get_setter(std::false_type) noexcept { return static_cast<field_entry::setter>(&field_helper::set); }
+        // no setter for const field
+        static auto get_setter(std::true_type) noexcept { return static_cast<field_entry::setter>(nullptr); }
+    };
+    // handle of ruby method, symbol interned once, method cached until class of receiver changed
+    template<typename Sig> class ruby_method;
+    // handle of ruby method, symbol interned once, method cached until class of receiver changed
+    template<typename R, typename... Args> class ruby_method<R(Args...)> {
+    public:
+        // ctor, receiver and cached method are kept from GC
+        ruby_method(mrb_state* mrb, const mrb_value& recv, const char* name) noexcept 
+            : mrb(mrb), recv(recv), mid(::mrb_intern_cstr(mrb, name)) { ::mrb_gc_register(mrb, recv); }
+        // move ctor
+        ruby_method(ruby_method&& m) noexcept 
+            : mrb(m.mrb), recv(m.recv), mid(m.mid), klass(m.klass), owner(m.owner), proc(m.proc) { m.mrb = nullptr; }
+        // no copy
+        ruby_method(const ruby_method&) = delete;
+        // no assign
+        ruby_method& operator=(const ruby_method&) = delete;
+        // dtor
+        ~ruby_method() noexcept { 
+            if (!mrb) return;
+            this->reset();
+            ::mrb_gc_unregister(mrb, recv);
+        }
+        // call; at top level a raise gives value-initialized result and mrb->exc is left for the caller,
+        // inside a bound call it longjmps through the c++ frames to the nearest rescue
+        auto operator()(Args... args) noexcept {
+            const auto cla = ::mrb_class(mrb, recv);
+            if (cla != klass) this->resolve(cla);
+            return callback_helper::invoke<R, Args...>(mrb, proc, recv, owner, mid, args...);
+        }
+        // drop cached method, call it after the method redefined: only a new class of receiver is detected
+        void reset() noexcept {
+            if (proc) ::mrb_gc_unregister(mrb, ::mrb_obj_value(proc));
+            klass = owner = nullptr;
+            proc = nullptr;
+        }
+        // get receiver
+        auto get_receiver() const noexcept { return recv; }
+    private:
+        // resolve method of class
+        void resolve(RClass* cla) noexcept {
+            this->reset();
+            auto c = cla;
+            proc = ::mrb_method_search_vm(mrb, &c, mid);
+            // called by name if the method needs a frame of its own
+            if (proc && !MRB_PROC_CFUNC_P(proc) && frame_helper::needs_frame(mrb, proc->body.irep)) proc = nullptr;
+            if (proc) ::mrb_gc_register(mrb, ::mrb_obj_value(proc));
+            klass = cla;
+            owner = c;
+        }
+    private:
+        // mruby state
+        mrb_state*      mrb;
+        // receiver
+        mrb_value       recv;
+        // name
+        mrb_sym         mid;
+        // class of receiver for cached method
+        RClass*         klass = nullptr;
+        // class defined the method
+        RClass*         owner = nullptr;
+        // cached method
+        RProc*          proc = nullptr;
+    };
+    // mode of batch call
+    enum class batch_mode : uint8_t {
+        // return results as array
+        collect,
+        // discard results, return the input array
+        discard,
+    };
+    // discard helper, call without boxing the result, owned<T> is still boxed to be freed by GC
+    template<typename CppClass, size_t Offset> struct discard_helper {
+        // call
+        template<typename Traits, typename T>
+        static void call(mrb_state* mrb, mrb_value self, const T& real_method, mrb_value* args) noexcept {
+            using result_type = typename std::decay<typename Traits::result_type>::type;
+            discard_helper::call<Traits>(mrb, self, real_method, args, is_owned<result_type>());
+        }
+    private:
+        // call, result owned by ruby
+        template<typename Traits, typename T>
+        static void call(mrb_state* mrb, mrb_value self, const T& real_method, mrb_value* args, std::true_type) noexcept {
+            invoke_helper<CppClass, Offset>::template call<Traits>(mrb, self, real_method, args);
+        }
+        // call, result dropped
+        template<typename Traits, typename T>
+        static void call(mrb_state* mrb, mrb_value self, const T& real_method, mrb_value* args, std::false_type) noexcept {
+            invoke_helper<CppClass, Offset>::template discard<Traits>(mrb, self, real_method, args);
+        }
+    };
+    // batch helper, call bound callable over an array in one native loop
+    template<typename CppClass, size_t Offset> struct batch_helper;
+    // batch helper: [rb]Foo.bar_each(receivers, *args) -> [cpp]member-function on every receiver
+    template<typename CppClass> struct batch_helper<CppClass, 1> {
+        // call
+        template<typename Traits, bool Collect, typename T>
+        static auto call(mrb_state* mrb, RClass* cla, const T& real_method, mrb_value* args, int narg) noexcept {
+            // receivers + shared args
+            raise_helper::raisenarg<Traits::arity>(mrb, narg);
+            if (!mrb_array_p(args[0])) raise_helper::raisearray(mrb, args[0]);
+            signature_helper<Traits, 1>::check(mrb, args + 1);
+            const auto list = args[0];
+            const auto out = Collect ? ::mrb_ary_new_capa(mrb, RARRAY_LEN(list)) : list;
+            const auto ai = ::mrb_gc_arena_save(mrb);
+            for (mrb_int i = 0; i < RARRAY_LEN(list); ++i) {
+                const auto recv = RARRAY_PTR(list)[i];
+                if (!batch_helper::is_receiver(mrb, recv, cla)) raise_helper::raiseelem(mrb, recv, i);
+                if (Collect) ::mrb_ary_push(mrb, out, invoke_helper<CppClass, 1>::template call<Traits>(mrb, recv, real_method, args + 1));
+                else discard_helper<CppClass, 1>::template call<Traits>(mrb, recv, real_method, args + 1);
+                ::mrb_gc_arena_restore(mrb, ai);
+            }
+            return out;
+        }
+    private:
+        // object of bound class
+        static bool is_receiver(mrb_state* mrb, const mrb_value& v, RClass* cla) noexcept {
+            const auto value = value_helper<CppClass>::value && mrb_type(v) == MRB_TT_ISTRUCT;
+            if (!value && (mrb_type(v) != MRB_TT_DATA || !DATA_PTR(v))) return false;
+            return ::mrb_obj_class(mrb, v) == cla || ::mrb_obj_is_kind_of(mrb, v, cla);
+        }
+    };
+    // batch helper: [rb]Foo.bar_each(tuples) -> [cpp]static-class-function on every argument tuple,
+    // element itself is the argument if arity is 1
+    template<typename CppClass> struct batch_helper<CppClass, 0> {
+        // call
+        template<typename Traits, bool Collect, typename T>
+        static auto call(mrb_state* mrb, RClass* cla, const T& real_method, mrb_value* args, int narg) noexcept {
+            (void)cla;
+            raise_helper::raisenarg<1>(mrb, narg);
+            if (!mrb_array_p(args[0])) raise_helper::raisearray(mrb, args[0]);
+            const auto list = args[0];
+            const auto self = ::mrb_nil_value();
+            const auto out = Collect ? ::mrb_ary_new_capa(mrb, RARRAY_LEN(list)) : list;
+            const auto ai = ::mrb_gc_arena_save(mrb);
+            for (mrb_int i = 0; i < RARRAY_LEN(list); ++i) {
+                auto tuple = const_cast<mrb_value*>(RARRAY_PTR(list)) + i;
+                if (Traits::arity != 1) {
+                    if (!mrb_array_p(*tuple)) raise_helper::raiseelem(mrb, *tuple, i);
+                    raise_helper::raisenarg<Traits::arity>(mrb, int(RARRAY_LEN(*tuple)));
+                    tuple = const_cast<mrb_value*>(RARRAY_PTR(*tuple));
+                }
+                signature_helper<Traits, 0>::check(mrb, tuple);
+                if (Collect) ::mrb_ary_push(mrb, out, invoke_helper<CppClass, 0>::template call<Traits>(mrb, self, real_method, tuple));
+                else discard_helper<CppClass, 0>::template call<Traits>(mrb, self, real_method, tuple);
+                ::mrb_gc_arena_restore(mrb, ai);
+            }
+            return out;
+        }
+    };
+    // thunk of binding table, static cfunc calling function given as template argument
+    template<typename CppClass, typename F, F Func> struct table_thunk {
+        // traits
+        using traits = type_helper<F>;
+        // first argument
+        using first_type = typename first_arg<traits>::type;
+        // offset of ruby arguments, 1 if object-ptr is the first argument
+        enum : size_t { 
+            offset = std::is_same<first_type, CppClass*>::value || std::is_same<first_type, const CppClass*>::value 
+        };
+        // call
+        static mrb_value call(mrb_state* mrb, mrb_value self) noexcept {
+            int narg; auto args = args_helper::get(mrb, narg);
+            // raise error for arg number/type
+            raise_helper::raisenarg<traits::arity - offset>(mrb, narg);
+            signature_helper<traits, offset>::check(mrb, args);
+            const auto func = Func;
+            return invoke_helper<CppClass, offset>::template call<traits>(mrb, self, func, args);
+        }
+    };
+    // entry of binding table, object-ptr as the first argument -> instance-method, otherwise -> class-method
+    template<typename CppClass, typename F, F Func> constexpr auto table_method(const char* name) noexcept {
+        return method_entry{ name, &table_thunk<CppClass, F, Func>::call, !table_thunk<CppClass, F, Func>::offset };
+    }
+#ifdef __cpp_nontype_template_parameter_auto
+    // entry of binding table, e.g. table_method<Foo, &foo_get>("get")
+    template<typename CppClass, auto Func> constexpr auto table_method(const char* name) noexcept {
+        return table_method<CppClass, decltype(Func), Func>(name);
+    }
+#endif
+    // source of lazy sequence: range or generator, elements pulled by BindER::Sequence#each
+    template<typename Source> struct lazy_sequence { Source source; };
+    // pair of iterators as range
+    template<typename It> struct iterator_range {
+        // first/last
+        It      first, last;
+        // begin
+        auto begin() const noexcept { return first; }
+        // end
+        auto end() const noexcept { return last; }
+    };
+    // generator, 'func(T&)' fills next element and returns false at end
+    template<typename T, typename F> struct generator_source { F func; };
+    // lazy sequence of iterators, borrowed: storage must outlive the sequence
+    template<typename It> auto lazy(It first, It last) {
+        return lazy_sequence<iterator_range<It>>{ { first, last } };
+    }
+    // lazy sequence of range, moved into the sequence
+    template<typename Range> auto lazy(Range&& range) {
+        return lazy_sequence<Range>{ std::move(range) };
+    }
+    // lazy sequence of range, borrowed: range must outlive the sequence
+    template<typename Range> auto lazy(Range& range) { return BindER::lazy(std::begin(range), std::end(range)); }
+    // lazy sequence of generator, single pass
+    template<typename T, typename F> auto generator(F func) {
+        return lazy_sequence<generator_source<T, F>>{ { std::move(func) } };
+    }
+    // position in sequence of one 'each' call
+    struct sequence_cursor {
+        // dtor
+        virtual ~sequence_cursor() noexcept = default;
+        // convert next element to 'v', false at end
+        virtual bool pull(mrb_state* mrb, mrb_value& v) noexcept = 0;
+    };
+    // sequence held by ruby object
+    struct sequence_base {
+        // dtor
+        virtual ~sequence_base() noexcept = default;
+        // new cursor at first element of range or next element of generator, nullptr if out of memory
+        virtual sequence_cursor* open() noexcept = 0;
+    };
+    // cursor of range, iterators into the range kept by sequence
+    template<typename It> struct range_cursor : sequence_cursor {
+        // element type
+        using value_type = typename std::decay<decltype(*std::declval<It&>())>::type;
+        // ctor
+        range_cursor(It first, It last) noexcept : cur(first), last(last) {}
+        // pull
+        bool pull(mrb_state* mrb, mrb_value& v) noexcept override {
+            if (cur == last) return false;
+            auto&& e = *cur;
+            v = ruby_arg<value_type>::set(mrb, [&e]() noexcept -> const value_type& { return e; }, nullptr);
+            ++cur;
+            return true;
+        }
+        // current/last iterator
+        It                                  cur, last;
+    };
+    // sequence of range
+    template<typename Range> struct sequence_impl : sequence_base {
+        // iterator type
+        using iterator = decltype(std::begin(std::declval<Range&>()));
+        // ctor
+        sequence_impl(Range&& r) noexcept : range(std::move(r)) {}
+        // open
+        sequence_cursor* open() noexcept override { 
+            return new(std::nothrow) range_cursor<iterator>(std::begin(range), std::end(range)); 
+        }
+        // range
+        Range                               range;
+    };
+    // sequence of generator, every cursor pulls from the same generator
+    template<typename T, typename F> struct sequence_impl<generator_source<T, F>> : sequence_base {
+        // cursor of generator, single pass
+        struct shared_cursor : sequence_cursor {
+            // ctor
+            shared_cursor(sequence_impl* seq) noexcept : seq(seq) {}
+            // pull
+            bool pull(mrb_state* mrb, mrb_value& v) noexcept override { return seq->next(mrb, v); }
+            // sequence
+            sequence_impl*                  seq;
+        };
+        // ctor
+        sequence_impl(generator_source<T, F>&& g) noexcept : func(std::move(g.func)) {}
+        // open, cursor refers to this sequence
+        sequence_cursor* open() noexcept override { return new(std::nothrow) shared_cursor(this); }
+        // convert next element to 'v', false at end
+        bool next(mrb_state* mrb, mrb_value& v) noexcept {
+            T e{};
+            if (!func(e)) return false;
+            v = ruby_arg<T>::set(mrb, [&e]() noexcept -> const T& { return e; }, nullptr);
+            return true;
+        }
+        // generator
+        F                                   func;
+    };
+    // helper for BindER::Sequence, defined in state on first use
+    struct sequence_helper {
+        // data type for sequence
+        static auto& get_type() noexcept {
+            static const mrb_data_type datatype = {
+                "BindER::sequence", [](mrb_state* mrb, void* ptr) {
+                    (void)mrb;
+                    if (ptr) delete static_cast<sequence_base*>(ptr);
                 }
             };
-            // method helper ex
-            template<typename First> struct method_helper_ex {
-                // bind
-                template<typename T> 
-                static inline auto bind(const class_binder<CppClass>& binder, const char* method_name, T method) noexcept {
-                    // no-arg -> [rb]class-method call [cpp]static-class-function
-                    // real ctor lambda to avoid capture
-                    static const auto real_method(method);
-                    using traits = type_helper<T>;
-                    // define
-                    ::mrb_define_class_method(binder.get_mruby(), binder.get_class(), method_name, [](mrb_state* mrb, mrb_value self) noexcept {
-                        (void)self;
-                        mrb_value* args; int narg;
-                        ::mrb_get_args(mrb, "*", &args, &narg);
-                        // raise error for arg number
-                        raise_helper::raisenarg<traits::arity>(mrb, narg);
-                        // no arg call
-                        auto no_arg_lambda = [args]() noexcept {
-                            return call_chain<traits::arity>::call<traits>(real_method, args);
-                        };
-                        return ruby_arg<type_helper<T>::result_type>::set(mrb, no_arg_lambda, args);
-                    }, MRB_ARGS_REQ(traits::arity));
+            return datatype;
+        }
+        // data type for cursor of 'each' call
+        static auto& get_cursor_type() noexcept {
+            static const mrb_data_type datatype = {
+                "BindER::cursor", [](mrb_state* mrb, void* ptr) {
+                    (void)mrb;
+                    if (ptr) delete static_cast<sequence_cursor*>(ptr);
                 }
             };
-            // method helper ex: for object-ptr
-            template<> struct method_helper_ex<CppClass*> {
-                // bind
-                template<typename T> 
-                static inline auto bind(const class_binder<CppClass>& binder, const char* method_name, T method) noexcept {
-                    // no-arg -> [rb]class-method call [cpp]static-class-function
-                    // real ctor lambda to avoid capture
-                    static const auto real_method(method);
-                    static const auto sc_method_name(method);
-                    using traits = type_helper<T>;
-                    // define
-                    ::mrb_define_method(binder.get_mruby(), binder.get_class(), method_name, [](mrb_state* mrb, mrb_value self) noexcept {
-                        auto obj = reinterpret_cast<CppClass*>(DATA_PTR(self));
-                        mrb_value* args; int narg;
-                        ::mrb_get_args(mrb, "*", &args, &narg);
-                        // raise error for arg number
-                        raise_helper::raisenarg<traits::arity - 1>(mrb, narg);
-                        // no arg call
-                        auto no_arg_lambda = [args, obj]() noexcept {
-                            return call_chain<traits::arity-1>::call<traits>(real_method, args-1, obj);
-                        };
-                        return ruby_arg<type_helper<T>::result_type>::set(mrb, no_arg_lambda, args);
-                    }, MRB_ARGS_REQ(traits::arity));
+            return datatype;
+        }
+        // wrap sequence to new ruby object
+        static auto wrap(mrb_state* mrb, sequence_base* seq) noexcept {
+            assert(seq && "out of memory");
+            return ::mrb_obj_value(::mrb_data_object_alloc(mrb, sequence_helper::get_class(mrb), seq, &get_type()));
+        }
+    private:
+        // get class, Enumerable with native each
+        static RClass* get_class(mrb_state* mrb) noexcept {
+            auto& ctx = state_context::get(mrb);
+            if (const auto cla = ctx.get_class<sequence_base>()) return cla;
+            const auto outer = ::mrb_define_module(mrb, "BindER");
+            const auto cla = ::mrb_define_class_under(mrb, outer, "Sequence", mrb->object_class);
+            MRB_SET_INSTANCE_TT(cla, MRB_TT_DATA);
+            ::mrb_undef_class_method(mrb, cla, "new");
+            ::mrb_include_module(mrb, cla, ::mrb_module_get(mrb, "Enumerable"));
+            ::mrb_define_method(mrb, cla, "each", &sequence_helper::each, MRB_ARGS_BLOCK());
+            ctx.set_class<sequence_base>(cla);
+            return cla;
+        }
+        // each, from first element for range, from next element for generator; enumerator if no block
+        static mrb_value each(mrb_state* mrb, mrb_value self) noexcept {
+            mrb_value blk; ::mrb_get_args(mrb, "&", &blk);
+            if (mrb_nil_p(blk)) return ::mrb_funcall(mrb, self, "to_enum", 1, ::mrb_symbol_value(mrb_intern_lit(mrb, "each")));
+            // cursor of this call owned by ruby: no local with dtor, break in block unwinds this frame,
+            // nested or interleaved calls each have their own
+            const auto cursor = static_cast<sequence_base*>(DATA_PTR(self))->open();
+            assert(cursor && "out of memory");
+            ::mrb_data_object_alloc(mrb, mrb->object_class, cursor, &get_cursor_type());
+            const auto ai = ::mrb_gc_arena_save(mrb);
+            mrb_value v;
+            while (cursor->pull(mrb, v)) {
+                ::mrb_yield(mrb, blk, v);
+                ::mrb_gc_arena_restore(mrb, ai);
+            }
+            return self;
+        }
+    };
+    // mruby arg to c++: for lazy sequence, returned as BindER::Sequence
+    template<typename Source> struct ruby_arg<lazy_sequence<Source>> {
+        // set mruby
+        template<typename Lam>
+        static auto set(mrb_state* ms, Lam lam, const mrb_value* /*arg*/) noexcept { 
+            return sequence_helper::wrap(ms, new(std::nothrow) sequence_impl<Source>(std::move(lam().source)));
+        }
+    };
+#ifdef BINDER_RUBY_ASYNC
+    // event loop of one mruby state: async calls run on its threads, fibers are resumed 
+    // with results by run()/poll() on the state's thread, outside of running script
+    class async_loop {
+        // convert result to ruby value, on the state's thread
+        using result_func = std::function<mrb_value(mrb_state*)>;
+        // completed operation
+        struct completed_op { uint64_t id; result_func result; };
+    public:
+        // work function, run on pool thread
+        using work_func = std::function<void()>;
+        // ctor, start 'count' threads, 0 for hardware concurrency
+        async_loop(mrb_state* mrb, size_t count) : mrb(mrb) {
+            const auto hardware = size_t(std::thread::hardware_concurrency());
+            if (!count) count = hardware ? hardware : 1;
+            threads.reserve(count);
+            for (size_t i = 0; i != count; ++i) threads.emplace_back([this]() noexcept { this->work(); });
+            state_context::get(mrb).set_loop(this);
+        }
+        // dtor, finish queued works and join threads, fibers still suspended are never resumed
+        ~async_loop() noexcept {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            work_cv.notify_all();
+            for (auto& thread : threads) thread.join();
+            const auto ctx = state_context::find(mrb);
+            if (!ctx) return;
+            ctx->set_loop(nullptr);
+            for (const auto& pair : fibers) ::mrb_gc_unregister(mrb, pair.second);
+        }
+        // no copy
+        async_loop(const async_loop&) = delete;
+        // no copy
+        async_loop& operator=(const async_loop&) = delete;
+        // submit work to pool threads
+        void submit(work_func work) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                works.push_back(std::move(work));
+            }
+            work_cv.notify_one();
+        }
+        // begin operation on current fiber, fiber kept from GC until resumed
+        auto begin() -> uint64_t {
+            const auto id = ++last_id;
+            if (mrb->c == mrb->root_c) return id;
+            const auto fiber = ::mrb_obj_value(mrb->c->fib);
+            ::mrb_gc_register(mrb, fiber);
+            fibers.emplace(id, fiber);
+            return id;
+        }
+        // complete operation from any thread, result converted on the state's thread
+        void complete(uint64_t id, result_func result) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                completed.push_back({ id, std::move(result) });
+            }
+            done_cv.notify_all();
+        }
+        // wait for operation begun on current fiber, as return value of bound method:
+        // fiber is suspended, root fiber cannot be suspended and blocks for this operation only
+        auto await(uint64_t id) -> mrb_value {
+            if (mrb->c != mrb->root_c) return ::mrb_fiber_yield(mrb, 0, nullptr);
+            result_func result;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                auto itr = completed.end();
+                done_cv.wait(lock, [this, id, &itr]() noexcept {
+                    for (itr = completed.begin(); itr != completed.end(); ++itr) if (itr->id == id) return true;
+                    return false;
+                });
+                result = std::move(itr->result);
+                completed.erase(itr);
+            }
+            return result(mrb);
+        }
+        // resume fibers until no operation pending, return count of resumed
+        auto run() -> size_t {
+            size_t count = 0;
+            while (!fibers.empty()) count += this->poll(true);
+            return count;
+        }
+        // resume fibers of completed operations, wait for one if 'wait', return count of resumed
+        auto poll(bool wait = false) -> size_t {
+            std::deque<completed_op> list;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (wait) done_cv.wait(lock, [this]() noexcept { return !completed.empty(); });
+                list.swap(completed);
+            }
+            for (auto& op : list) this->resume(op);
+            return list.size();
+        }
+        // count of suspended fibers
+        auto get_pending() const noexcept { return fibers.size(); }
+        // count of resumed fibers raised exception
+        auto get_errors() const noexcept { return errors; }
+        // get mruby
+        auto get_mruby() const noexcept { return mrb; }
+    private:
+        // resume fiber with result
+        void resume(completed_op& op) {
+            const auto itr = fibers.find(op.id);
+            if (itr == fibers.end()) return;
+            const auto fiber = itr->second;
+            fibers.erase(itr);
+            const auto ai = ::mrb_gc_arena_save(mrb);
+            const auto value = op.result(mrb);
+            ::mrb_fiber_resume(mrb, fiber, 1, &value);
+            if (mrb->exc) {
+                mrb->exc = nullptr;
+                ++errors;
+            }
+            ::mrb_gc_unregister(mrb, fiber);
+            ::mrb_gc_arena_restore(mrb, ai);
+        }
+        // pool thread
+        void work() noexcept {
+            while (true) {
+                work_func work;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    work_cv.wait(lock, [this]() noexcept { return stopping || !works.empty(); });
+                    if (works.empty()) break;
+                    work = std::move(works.front());
+                    works.pop_front();
                 }
+                work();
+            }
+        }
+    private:
+        // mruby state
+        mrb_state* const            mrb;
+        // threads
+        std::vector<std::thread>    threads;
+        // mutex for queues
+        std::mutex                  mutex;
+        // cv for new work
+        std::condition_variable     work_cv;
+        // cv for completed operation
+        std::condition_variable     done_cv;
+        // queue of works
+        std::deque<work_func>       works;
+        // queue of completed operations
+        std::deque<completed_op>    completed;
+        // suspended fibers by operation, state's thread only
+        std::unordered_map<uint64_t, mrb_value> fibers;
+        // last operation id
+        uint64_t                    last_id = 0;
+        // count of resumed fibers raised exception
+        size_t                      errors = 0;
+        // stop flag
+        bool                        stopping = false;
+    };
+    // completion of async operation, call once from any thread with the result
+    template<typename R> class completion {
+    public:
+        // ctor
+        completion(async_loop* loop, uint64_t id) noexcept : loop(loop), id(id) {}
+        // complete with result, converted by ruby_arg<R>::set on the state's thread
+        void operator()(R result) const {
+            loop->complete(id, [result](mrb_state* mrb) noexcept {
+                return ruby_arg<R>::set(mrb, [&result]() noexcept -> const R& { return result; }, nullptr);
+            });
+        }
+        // get id
+        auto get_id() const noexcept { return id; }
+    private:
+        // loop
+        async_loop*     loop;
+        // operation id
+        uint64_t        id;
+    };
+    // completion of async operation without result
+    template<> class completion<void> {
+    public:
+        // ctor
+        completion(async_loop* loop, uint64_t id) noexcept : loop(loop), id(id) {}
+        // complete, nil to ruby
+        void operator()() const { loop->complete(id, [](mrb_state*) noexcept { return ::mrb_nil_value(); }); }
+        // get id
+        auto get_id() const noexcept { return id; }
+    private:
+        // loop
+        async_loop*     loop;
+        // operation id
+        uint64_t        id;
+    };
+    // type helper for last argument, decayed, void if no argument
+    template<typename TypeHelper, bool = (TypeHelper::arity > 0)> struct last_arg { using type = void; };
+    // type helper for last argument
+    template<typename TypeHelper> struct last_arg<TypeHelper, true> { 
+        using type = typename std::decay<typename TypeHelper::template arg<TypeHelper::arity - 1>::type>::type; 
+    };
+    // completion helper, traits of ruby arguments
+    template<typename TypeHelper, typename = typename last_arg<TypeHelper>::type> 
+    struct completion_helper : std::false_type { using traits = TypeHelper; };
+    // completion helper, completion<R> as the last argument is not from ruby
+    template<typename TypeHelper, typename R> struct completion_helper<TypeHelper, completion<R>> : std::true_type {
+        // traits of ruby arguments
+        struct traits {
+            // number of arguments
+            enum : size_t { arity = TypeHelper::arity - 1 };
+            // result type
+            using result_type = R;
+            // arg type
+            template <size_t i> struct arg { using type = typename TypeHelper::template arg<i>::type; };
+        };
+    };
+    // string copied for pool thread, converted back to the argument type there
+    struct async_string {
+        // copy
+        std::string value;
+        // to c-string
+        operator const char*() const noexcept { return value.c_str(); }
+#ifdef BINDER_RUBY_STRING_VIEW
+        // to string view
+        operator std::string_view() const noexcept { return value; }
+#endif
+    };
+    // span copied for pool thread, converted back to span there
+    template<typename T> struct async_span {
+        // copy
+        std::vector<typename std::remove_const<T>::type> value;
+        // to span
+        operator span<T>() const noexcept { return span<T>{ value.data(), value.size() }; }
+    };
+    // argument of pool job, owning one as is, borrowed string/span copied on the state's thread
+    template<typename P> struct async_param { static auto keep(const P& p) { return p; } };
+    // argument of pool job: c-string in ruby string
+    template<> struct async_param<char*> { static auto keep(const char* p) { return async_string{ p }; } };
+    // argument of pool job: c-string in ruby string
+    template<> struct async_param<const char*> { static auto keep(const char* p) { return async_string{ p }; } };
+#ifdef BINDER_RUBY_STRING_VIEW
+    // argument of pool job: view of ruby string
+    template<> struct async_param<std::string_view> { 
+        static auto keep(std::string_view p) { return async_string{ std::string(p) }; } 
+    };
+#endif
+    // argument of pool job: span of ruby string
+    template<typename T> struct async_param<span<T>> { 
+        static auto keep(const span<T>& p) { return async_span<T>{ { p.data, p.data + p.size } }; } 
+    };
+    // async helper, arguments converted on the state's thread and copied to work on pool thread
+    template<typename CppClass, size_t Offset> struct async_helper {
+        // call by completion, callable called on the state's thread with completion<R> as the last argument
+        template<typename Traits, typename T>
+        static mrb_value call(mrb_state* mrb, mrb_value self, const T& method, mrb_value* args, std::true_type) noexcept {
+            using result_type = typename Traits::result_type;
+            const auto loop = state_context::get(mrb).get_loop();
+            assert(loop && "async_loop not created for this state");
+            uint64_t id = 0;
+            auto start = [loop, &method, &id](auto&&... params) noexcept {
+                method(std::forward<decltype(params)>(params)..., completion<result_type>(loop, id = loop->begin()));
+            };
+            async_helper::start<Traits>(mrb, self, start, args, std::integral_constant<size_t, Offset>());
+            return loop->await(id);
+        }
+        // call on pool thread, result of current fiber's operation returned
+        template<typename Traits, typename T>
+        static mrb_value call(mrb_state* mrb, mrb_value self, const T& method, mrb_value* args, std::false_type) noexcept {
+            using result_type = typename Traits::result_type;
+            const auto loop = state_context::get(mrb).get_loop();
+            assert(loop && "async_loop not created for this state");
+            const auto func = &method;
+            uint64_t id = 0;
+            // operation begins after every argument converted, nothing pending if raised
+            auto start = [loop, func, &id](auto&&... params) noexcept {
+                const completion<result_type> done(loop, id = loop->begin());
+                loop->submit(async_helper::job(func, done, async_param<std::decay_t<decltype(params)>>::keep(params)...));
+            };
+            async_helper::start<Traits>(mrb, self, start, args, std::integral_constant<size_t, Offset>());
+            return loop->await(id);
+        }
+    private:
+        // job of pool thread, owning copies of arguments only
+        template<typename R, typename F, typename... Params>
+        static auto job(const F* func, const completion<R>& done, Params... params) noexcept {
+            return [func, done, params...]() noexcept { async_helper::finish(done, *func, params...); };
+        }
+        // start class-method
+        template<typename Traits, typename Lam>
+        static void start(mrb_state* mrb, mrb_value, Lam& lam, mrb_value* args, std::integral_constant<size_t, 0>) noexcept {
+            call_helper<Traits::arity>::template call<Traits>(mrb, lam, args);
+        }
+        // start instance-method, object-ptr as the first argument
+        template<typename Traits, typename Lam>
+        static void start(mrb_state* mrb, mrb_value self, Lam& lam, mrb_value* args, std::integral_constant<size_t, 1>) noexcept {
+            call_helper<Traits::arity - 1>::template call<Traits>(mrb, lam, args - 1, object_of<CppClass>(self));
+        }
+        // finish with result
+        template<typename R, typename F, typename... Params>
+        static void finish(const completion<R>& done, const F& func, const Params&... params) noexcept { done(func(params...)); }
+        // finish without result
+        template<typename F, typename... Params>
+        static void finish(const completion<void>& done, const F& func, const Params&... params) noexcept { func(params...); done(); }
+    };
+#endif
+    // mruby binder
+    class mruby_binder {
+    public:
+        // class binder
+        template<typename CppClass>
+        class class_binder {
+            // offset of ruby arguments, 1 if object-ptr is the first argument
+            template<typename T> struct offset_helper {
+                // first argument
+                using first_type = typename first_arg<type_helper<T>>::type;
+                // offset
+                enum : size_t { 
+                    value = std::is_same<first_type, CppClass*>::value || std::is_same<first_type, const CppClass*>::value 
+                };
             };
-            // method helper ex: for const object-pointer
-            template<> struct method_helper_ex<const CppClass*> : method_helper_ex<CppClass*> { };
         public:
             // get class
-            static inline auto get_class() noexcept { return data_type_helper<CppClass>::get_type().classr; }
+            auto get_class() const noexcept { return state_context::get(mstate).get_class<CppClass>(); }
+            // get singleton class for class-method
+            auto get_singleton() const noexcept { 
+                return mrb_class_ptr(::mrb_singleton_class(mstate, ::mrb_obj_value(get_class())));
+            }
             // get mruby
             auto get_mruby() const noexcept { return mstate; }
+            // get stats of slab pool, all zero if not pooled
+            auto get_pool_stats() const noexcept {
+                const auto pool = state_context::get(mstate).find_pool<CppClass>();
+                return pool ? pool->get_stats() : pool_stats{ 0, 0, 0 };
+            }
             // ctor
             class_binder(mrb_state* s) noexcept : mstate(s) { assert(mstate && "bad argument"); };
             // copy ctor
             class_binder(const class_binder<CppClass>& b) noexcept : mstate(b.mstate) { assert(mstate && "bad argument"); };
-            // bind
+            // bind, object-ptr as the first argument -> instance-method, otherwise -> class-method
             template<typename T> auto bind(const char* method_name, T method) {
-#ifdef _DEBUG
-                static bool isfirst = true;
-                assert(isfirst && "cannot call twice with same template");
-                isfirst = false;
+                // helper
+                using closure = closure_helper<T>;
+                using traits = type_helper<T>;
+                using offset = offset_helper<T>;
+                // define
+                closure::define(mstate, offset::value ? get_class() : get_singleton(), method_name, [](mrb_state* mrb, mrb_value self) noexcept {
+                    profile_probe probe(mrb);
+                    auto& real_method = closure::get(mrb);
+                    int narg; auto args = args_helper::get(mrb, narg);
+                    // raise error for arg number/type
+                    raise_helper::raisenarg<traits::arity - offset::value>(mrb, narg);
+                    signature_helper<traits, offset::value>::check(mrb, args);
+                    return probe.finish(invoke_helper<CppClass, offset::value>::template call<traits>(mrb, self, probe.wrap(real_method), args));
+                }, method, attach_binding(mstate, get_class(), method_name, !offset::value));
+            }
+#ifdef BINDER_RUBY_ASYNC
+            // bind async, the calling fiber is suspended until done, root fiber blocks:
+            // callable runs on pool thread of async_loop with arguments copied, or called at once 
+            // with BindER::completion<R> as the last argument to be called from any thread
+            template<typename T> auto bind_async(const char* method_name, T method) {
+                // helper
+                using closure = closure_helper<T>;
+                using with_completion = completion_helper<type_helper<T>>;
+                using traits = typename with_completion::traits;
+                using offset = offset_helper<T>;
+                // define
+                closure::define(mstate, offset::value ? get_class() : get_singleton(), method_name, [](mrb_state* mrb, mrb_value self) noexcept {
+                    profile_probe probe(mrb);
+                    auto& real_method = closure::get(mrb);
+                    int narg; auto args = args_helper::get(mrb, narg);
+                    // raise error for arg number/type
+                    raise_helper::raisenarg<traits::arity - offset::value>(mrb, narg);
+                    signature_helper<traits, offset::value>::check(mrb, args);
+                    return probe.finish(async_helper<CppClass, offset::value>::template call<traits>(
+                        mrb, self, real_method, args, with_completion()
+                        ));
+                }, method, attach_binding(mstate, get_class(), method_name, !offset::value));
+            }
 #endif
+            // bind overload set under one name, selected by arity and argument types
+            template<typename T, typename... Others> auto bind_overload(const char* method_name, T method, Others... others) {
                 // helper
+                using offset = offset_helper<T>;
+                using set_type = overload_set<CppClass, offset::value, T, Others...>;
+                using closure = closure_helper<set_type>;
+                static_assert(std::is_same<std::integer_sequence<size_t, offset::value, offset_helper<Others>::value...>,
+                    std::integer_sequence<size_t, offset_helper<Others>::value..., offset::value>>::value, 
+                    "instance-method and class-method cannot be mixed");
+                // define
+                closure::define(mstate, offset::value ? get_class() : get_singleton(), method_name, [](mrb_state* mrb, mrb_value self) noexcept {
+                    profile_probe probe(mrb);
+                    auto& real_set = closure::get(mrb);
+                    int narg; auto args = args_helper::get(mrb, narg);
+                    return probe.finish(real_set.call(mrb, self, args, narg, probe));
+                }, set_type(method, others...), attach_binding(mstate, get_class(), method_name, !offset::value));
+            }
+            // bind with batch variant 'name_each' as class-method, results collected or discarded:
+            // instance-method -> Foo.bar_each(receivers, *args), class-method -> Foo.bar_each(tuples)
+            template<typename T> auto bind_batch(const char* method_name, T method, batch_mode mode = batch_mode::collect) {
+                this->bind(method_name, method);
+                const auto name = std::string(method_name) + "_each";
+                const auto func = mode == batch_mode::collect ? 
+                    &class_binder::batch_thunk<T, true> : &class_binder::batch_thunk<T, false>;
+                closure_helper<T>::define(mstate, get_singleton(), name.c_str(), func, method, 
+                    attach_binding(mstate, get_class(), name.c_str(), true));
+            }
+            // bind field by member pointer: getter 'name', setter 'name=' if not const,
+            // to_h/from_h/to_a/from_a for every bound field are defined with the first one
+            template<typename T> auto bind_attr(const char* attr_name, T CppClass::* member) {
+                using helper = field_helper<CppClass, T>;
+                using closure = closure_helper<T CppClass::*>;
+                const auto cla = get_class();
+                auto& fields = state_context::get(mstate).get_fields<CppClass>();
+                if (fields.empty()) this->bind_fields();
+                fields.push_back(helper::make(::mrb_intern_cstr(mstate, attr_name), member));
+                // getter, no argument
+                closure::define(mstate, cla, attr_name, [](mrb_state* mrb, mrb_value self) noexcept {
+                    profile_probe probe(mrb);
+                    const auto obj = object_of<const CppClass>(self);
+                    return probe.finish(helper::get(mrb, obj, closure::get(mrb)));
+                }, member, attach_binding(mstate, cla, attr_name, false));
+                this->bind_setter(cla, attr_name, member, std::is_const<T>());
+            }
+            // bind table of table_method entries in one pass, table must be static,
+            // defined on first call by method_missing if 'lazy'
+            template<size_t N> void bind_table(const method_entry (&table)[N], bool lazy = false) { 
+                this->bind_table(table, N, lazy); 
+            }
+            // bind table of table_method entries in one pass
+            void bind_table(const method_entry* table, size_t count, bool lazy = false) {
+                auto& ctx = state_context::get(mstate);
+                const auto cla = get_class();
+                const auto singleton = get_singleton();
+                const auto class_name = ::mrb_class_name(mstate, cla);
+                for (size_t i = 0; i != count; ++i) {
+                    const auto& entry = table[i];
+                    const auto target = entry.singleton ? singleton : cla;
+                    ctx.add_binding(class_name, entry.name, entry.singleton);
+                    // name found on class or ancestors never reaches method_missing, defined at once
+                    if (!lazy || ::mrb_obj_respond_to(mstate, target, ::mrb_intern_cstr(mstate, entry.name))) 
+                        ::mrb_define_method(mstate, target, entry.name, entry.func, MRB_ARGS_ANY());
+                }
+                if (!lazy || !ctx.add_lazy<CppClass>(table, count)) return;
+                // previous method_missing/respond_to_missing? called for names not in tables
+                for (const bool is_singleton : { false, true }) {
+                    for (const bool respond : { false, true }) {
+                        auto owner = is_singleton ? singleton : cla;
+                        const auto proc = ::mrb_method_search_vm(mstate, &owner, 
+                            respond ? mrb_intern_lit(mstate, "respond_to_missing?") : mrb_intern_lit(mstate, "method_missing"));
+                        if (proc) ::mrb_gc_register(mstate, ::mrb_obj_value(proc));
+                        ctx.get_replaced<CppClass>(is_singleton, respond) = { proc, owner };
+                    }
+                }
+                ::mrb_define_method(mstate, cla, "method_missing", &class_binder::missing_thunk<false>, MRB_ARGS_ANY());
+                ::mrb_define_method(mstate, singleton, "method_missing", &class_binder::missing_thunk<true>, MRB_ARGS_ANY());
+                ::mrb_define_method(mstate, cla, "respond_to_missing?", &class_binder::respond_thunk<false>, MRB_ARGS_ARG(1, 1));
+                ::mrb_define_method(mstate, singleton, "respond_to_missing?", &class_binder::respond_thunk<true>, MRB_ARGS_ARG(1, 1));
+            }
+            // set constant native size of every object owned by ruby, charged to gc pacing
+            void set_gc_size(size_t bytes) noexcept { 
+                auto& gc = state_context::get(mstate).get_gc<CppClass>();
+                gc.cost = bytes; gc.size_fn = nullptr; gc.size = nullptr;
+            }
+            // set native size callback, called once when ruby takes the ownership
+            void set_gc_size(size_t(*size)(const CppClass*)) noexcept {
+                auto& gc = state_context::get(mstate).get_gc<CppClass>();
+                gc.size_fn = reinterpret_cast<void(*)()>(size);
+                gc.size = [](void(*fn)(), const void* obj) noexcept {
+                    return reinterpret_cast<size_t(*)(const CppClass*)>(fn)(static_cast<const CppClass*>(obj));
+                };
+            }
+            // set mark hook for object holding ruby values: the values are snapshot into the wrapper when linked,
+            // by binder.mark_objects() and before a full GC forced by native bytes, never by mruby's own GC;
+            // a value stored by c++ between snapshots is not kept until mark_objects() is called
+            void set_gc_mark(void(*mark)(const CppClass*, gc_marker&)) noexcept {
+                auto& gc = state_context::get(mstate).get_gc<CppClass>();
+                gc.mark_fn = reinterpret_cast<void(*)()>(mark);
+                gc.mark = [](void(*fn)(), const void* obj, gc_marker& marker) noexcept {
+                    reinterpret_cast<void(*)(const CppClass*, gc_marker&)>(fn)(static_cast<const CppClass*>(obj), marker);
+                };
+            }
+        private:
+            // call method replaced by lazy table in frame of the same name, super goes on from its owner
+            static mrb_value call_replaced(mrb_state* mrb, mrb_value self, const replaced_method& replaced, 
+                mrb_int argc, const mrb_value* argv) noexcept {
+                // arguments copied out of the frame, the stack may be reallocated by the call
+                const auto args = ::mrb_ary_new_from_values(mrb, argc, argv);
+                return ::mrb_yield_with_class(mrb, ::mrb_obj_value(replaced.proc), argc, RARRAY_PTR(args), self, replaced.owner);
+            }
+            // method_missing of lazy table, define method then call it, replaced one for others
+            template<bool Singleton> static mrb_value missing_thunk(mrb_state* mrb, mrb_value self) noexcept {
+                mrb_value* argv; mrb_int argc; mrb_value block;
+                ::mrb_get_args(mrb, "*&", &argv, &argc, &block);
+                if (argc < 1 || !mrb_symbol_p(argv[0])) ::mrb_raise(mrb, E_ARGUMENT_ERROR, "no method name given");
+                const auto name = mrb_symbol(argv[0]);
+                auto& ctx = state_context::get(mrb);
+                const auto entry = ctx.find_lazy<CppClass>(::mrb_sym2name(mrb, name), Singleton);
+                if (!entry) {
+                    const auto& replaced = ctx.get_replaced<CppClass>(Singleton, false);
+                    if (replaced.proc) return class_binder::call_replaced(mrb, self, replaced, argc, argv);
+                    ::mrb_raisef(mrb, E_NOMETHOD_ERROR, "undefined method '%S' for %S", ::mrb_sym2str(mrb, name), self);
+                    return ::mrb_nil_value();
+                }
+                const auto cla = ctx.get_class<CppClass>();
+                const auto target = Singleton ? mrb_class_ptr(::mrb_singleton_class(mrb, ::mrb_obj_value(cla))) : cla;
+                ::mrb_define_method_id(mrb, target, name, entry->func, MRB_ARGS_ANY());
+                // arguments copied out of the frame, the stack may be reallocated by the call
+                const auto args = ::mrb_ary_new_from_values(mrb, argc - 1, argv + 1);
+                return ::mrb_funcall_with_block(mrb, self, name, argc - 1, RARRAY_PTR(args), block);
+            }
+            // respond_to_missing? of lazy table, replaced one for names not in tables
+            template<bool Singleton> static mrb_value respond_thunk(mrb_state* mrb, mrb_value self) noexcept {
+                mrb_value* argv; mrb_int argc;
+                ::mrb_get_args(mrb, "*", &argv, &argc);
+                if (argc < 1 || !mrb_symbol_p(argv[0])) ::mrb_raise(mrb, E_ARGUMENT_ERROR, "no method name given");
+                auto& ctx = state_context::get(mrb);
+                if (ctx.find_lazy<CppClass>(::mrb_sym2name(mrb, mrb_symbol(argv[0])), Singleton)) return ::mrb_true_value();
+                const auto& replaced = ctx.get_replaced<CppClass>(Singleton, true);
+                return replaced.proc ? class_binder::call_replaced(mrb, self, replaced, argc, argv) : ::mrb_false_value();
+            }
+            // no setter for const field
+            template<typename T> void bind_setter(RClass*, const char*, T CppClass::*, std::true_type) noexcept { }
+            // setter, one argument from the frame
+            template<typename T> void bind_setter(RClass* cla, const char* attr_name, T CppClass::* member, std::false_type) noexcept {
+                using helper = field_helper<CppClass, T>;
+                using closure = closure_helper<T CppClass::*>;
+                const auto setter_name = std::string(attr_name) + "=";
+                closure::define(mstate, cla, setter_name.c_str(), [](mrb_state* mrb, mrb_value self) noexcept {
+                    profile_probe probe(mrb);
+                    int narg; auto args = args_helper::frame(mrb, narg);
+                    raise_helper::raisenarg<1>(mrb, narg);
+                    const auto obj = object_of<CppClass>(self);
+                    if (!helper::set(mrb, obj, closure::get(mrb), args[0])) raise_helper::raisetype(mrb, args[0], 0);
+                    return probe.finish(args[0]);
+                }, member, attach_binding(mstate, cla, setter_name.c_str(), false));
+            }
+            // bind to_h/from_h/to_a/from_a
+            void bind_fields() noexcept {
+                const auto cla = get_class();
+                // fields of current call
+                struct list {
+                    // get
+                    static auto& get(mrb_state* mrb) noexcept { return state_context::get(mrb).get_fields<CppClass>(); }
+                };
+                this->bind_field_method(cla, "to_h", [](mrb_state* mrb, mrb_value self) noexcept {
+                    profile_probe probe(mrb);
+                    const auto& fields = list::get(mrb);
+                    const auto obj = object_of<CppClass>(self);
+                    auto hash = ::mrb_hash_new_capa(mrb, int(fields.size()));
+                    const auto ai = ::mrb_gc_arena_save(mrb);
+                    for (const auto& f : fields) {
+                        ::mrb_hash_set(mrb, hash, ::mrb_symbol_value(f.name), f.get(mrb, obj, f));
+                        ::mrb_gc_arena_restore(mrb, ai);
+                    }
+                    return probe.finish(hash);
+                });
+                this->bind_field_method(cla, "to_a", [](mrb_state* mrb, mrb_value self) noexcept {
+                    profile_probe probe(mrb);
+                    const auto& fields = list::get(mrb);
+                    const auto obj = object_of<CppClass>(self);
+                    auto ary = ::mrb_ary_new_capa(mrb, mrb_int(fields.size()));
+                    const auto ai = ::mrb_gc_arena_save(mrb);
+                    for (const auto& f : fields) {
+                        ::mrb_ary_push(mrb, ary, f.get(mrb, obj, f));
+                        ::mrb_gc_arena_restore(mrb, ai);
+                    }
+                    return probe.finish(ary);
+                });
+                // missing keys are left unchanged
+                this->bind_field_method(cla, "from_h", [](mrb_state* mrb, mrb_value self) noexcept {
+                    profile_probe probe(mrb);
+                    int narg; auto args = args_helper::frame(mrb, narg);
+                    raise_helper::raisenarg<1>(mrb, narg);
+                    if (!mrb_hash_p(args[0])) raise_helper::raisetype(mrb, args[0], 0);
+                    const auto& fields = list::get(mrb);
+                    const auto obj = object_of<CppClass>(self);
+                    for (const auto& f : fields) {
+                        if (!f.set) continue;
+                        const auto v = ::mrb_hash_fetch(mrb, args[0], ::mrb_symbol_value(f.name), ::mrb_undef_value());
+                        if (!mrb_undef_p(v) && !f.set(mrb, obj, f, v)) raise_helper::raisefield(mrb, v, f.name);
+                    }
+                    return probe.finish(self);
+                });
+                // values in order of binding, extra fields are left unchanged
+                this->bind_field_method(cla, "from_a", [](mrb_state* mrb, mrb_value self) noexcept {
+                    profile_probe probe(mrb);
+                    int narg; auto args = args_helper::frame(mrb, narg);
+                    raise_helper::raisenarg<1>(mrb, narg);
+                    if (!mrb_array_p(args[0])) raise_helper::raisetype(mrb, args[0], 0);
+                    const auto& fields = list::get(mrb);
+                    const auto obj = object_of<CppClass>(self);
+                    for (size_t i = 0; i < fields.size() && mrb_int(i) < RARRAY_LEN(args[0]); ++i) {
+                        const auto& f = fields[i];
+                        const auto v = RARRAY_PTR(args[0])[i];
+                        if (f.set && !f.set(mrb, obj, f, v)) raise_helper::raisefield(mrb, v, f.name);
+                    }
+                    return probe.finish(self);
+                });
+            }
+            // bind one of to_h/from_h/to_a/from_a
+            template<typename T> void bind_field_method(RClass* cla, const char* name, T method) noexcept {
+                closure_helper<T>::define(mstate, cla, name, method, method, attach_binding(mstate, cla, name, false));
+            }
+            // thunk of batch variant
+            template<typename T, bool Collect> static mrb_value batch_thunk(mrb_state* mrb, mrb_value) noexcept {
+                profile_probe probe(mrb);
                 using traits = type_helper<T>;
-                method_helper<traits::arity>::bind(*this, method_name, method);
+                auto& real_method = closure_helper<T>::get(mrb);
+                int narg; auto args = args_helper::get(mrb, narg);
+                return probe.finish(batch_helper<CppClass, offset_helper<T>::value>::template call<traits, Collect>(
+                    mrb, state_context::get(mrb).get_class<CppClass>(), probe.wrap(real_method), args, narg
+                    ));
             }
         private:
             // state of mruby
             mrb_state*      mstate = nullptr;
         };
+    private:
+        // pooled ctor
+        template<typename T, typename Ctor> struct pooled_ctor { Ctor ctor; slab_pool<T>* pool; };
+        // ctor helper
+        template<typename T, typename Ctor, typename = typename first_arg<type_helper<Ctor>>::type> 
+        struct ctor_helper {
+            // bind
+            static void bind(mrb_state* mrb, RClass* cla, const Ctor& ctor) noexcept {
+                using traits = type_helper<Ctor>;
+                using closure = closure_helper<Ctor>;
+                // define initialize method
+                auto initialize_this = [](mrb_state *mrb, mrb_value self) noexcept {
+                    profile_probe probe(mrb);
+                    auto&& real_ctor = probe.wrap(closure::get(mrb));
+                    DATA_TYPE(self) = &data_type_helper<T>::get_type();
+                    int narg; auto args = args_helper::get(mrb, narg);
+                    // raise error for arg number/type
+                    raise_helper::raisenarg<traits::arity>(mrb, narg);
+                    signature_helper<traits, 0>::check(mrb, args);
+                    DATA_PTR(self) = call_helper<traits::arity>::template call<traits>(mrb, real_ctor, args);
+                    object_helper<T>::track(mrb, self);
+                    return probe.finish(self);
+                };
+                closure::define(mrb, cla, "initialize", initialize_this, ctor, attach_binding(mrb, cla, "initialize", false));
+            }
+        };
+        // ctor helper: for pooled ctor, first argument is pool_slot<T>
+        template<typename T, typename Ctor> struct ctor_helper<T, Ctor, pool_slot<T>> {
+            // bind
+            static void bind(mrb_state* mrb, RClass* cla, const Ctor& ctor) noexcept {
+                using traits = type_helper<Ctor>;
+                using closure = closure_helper<pooled_ctor<T, Ctor>>;
+                // define initialize method
+                auto initialize_this = [](mrb_state *mrb, mrb_value self) noexcept {
+                    profile_probe probe(mrb);
+                    auto& real_ctor = closure::get(mrb);
+                    auto&& real_body = probe.wrap(real_ctor.ctor);
+                    DATA_TYPE(self) = &slab_pool<T>::get_type();
+                    int narg; auto args = args_helper::get(mrb, narg);
+                    // raise error for arg number/type
+                    raise_helper::raisenarg<traits::arity - 1>(mrb, narg);
+                    signature_helper<traits, 1>::check(mrb, args);
+                    const auto ptr = real_ctor.pool->acquire();
+                    DATA_PTR(self) = ptr ? call_helper<traits::arity - 1>::template call<traits>(
+                        mrb, real_body, args - 1, pool_slot<T>(ptr)
+                        ) : nullptr;
+                    object_helper<T>::track(mrb, self);
+                    return probe.finish(self);
+                };
+                const pooled_ctor<T, Ctor> pooled = { ctor, &state_context::get(mrb).get_pool<T>() };
+                closure::define(mrb, cla, "initialize", initialize_this, pooled, attach_binding(mrb, cla, "initialize", false));
+            }
+        };
+        // ctor helper: for value class, object constructed in place of MRB_TT_ISTRUCT
+        template<typename T, typename Ctor> struct value_ctor_helper {
+            // bind
+            static void bind(mrb_state* mrb, RClass* cla, const Ctor& ctor) noexcept {
+                using traits = type_helper<Ctor>;
+                using closure = closure_helper<Ctor>;
+                // define initialize method
+                auto initialize_this = [](mrb_state *mrb, mrb_value self) noexcept {
+                    profile_probe probe(mrb);
+                    auto&& real_ctor = probe.wrap(closure::get(mrb));
+                    int narg; auto args = args_helper::get(mrb, narg);
+                    // raise error for arg number/type
+                    raise_helper::raisenarg<traits::arity>(mrb, narg);
+                    signature_helper<traits, 0>::check(mrb, args);
+                    const T obj = call_helper<traits::arity>::template call<traits>(mrb, real_ctor, args);
+                    std::memcpy(ISTRUCT_PTR(self), &obj, sizeof(T));
+                    return probe.finish(self);
+                };
+                closure::define(mrb, cla, "initialize", initialize_this, ctor, attach_binding(mrb, cla, "initialize", false));
+            }
+        };
     public:
         // ctor
         mruby_binder(mrb_state* state) noexcept : mstate(state) { assert(mstate && "bad argument"); };
@@ -348,7 +3120,8 @@ namespace BindER {
         inline auto bind_module(const char* module_name, RClass* outer) noexcept {
             // define class
             auto cla = ::mrb_define_module_under(mstate, outer, module_name);
-            return class_binder<T>(mstate, cla);
+            state_context::get(mstate).set_class<T>(cla);
+            return class_binder<T>(mstate);
         }
         // bind class
         template<typename T> inline auto bind_class(const char* class_name, T ctor) noexcept {
@@ -356,39 +3129,337 @@ namespace BindER {
         }
         // bind class with outer and super
         template<typename T> inline auto bind_class(const char* class_name, T ctor, RClass* outer, RClass* super) noexcept {
-#ifdef _DEBUG
-            static bool isfirst = true;
-            assert(isfirst && "cannot call twice with same template");
-            isfirst = false;
-#endif
             // define class
             auto cla = ::mrb_define_class_under(mstate, outer, class_name, super);
             assert(cla && "error from mruby or bad action");
             MRB_SET_INSTANCE_TT(cla, MRB_TT_DATA);
             using traits = type_helper<T>;
-            using class_type = type_helper_ptr<traits::result_type>::type;
+            using class_type = typename type_helper_ptr<typename traits::result_type>::type;
             // data type
-            data_type_helper<class_type>::set_type(class_name, cla);
-            // real ctor lambda to avoid capture
-            static const auto real_ctor(ctor);
+            data_type_helper<class_type>::get_type(class_name);
+            state_context::get(mstate).set_class<class_type>(cla);
             // define initialize method
-            auto initialize_this = [](mrb_state *mrb, mrb_value self) noexcept {
-                DATA_TYPE(self) = &data_type_helper<class_type>::get_type().mrb_dt;
-                mrb_value* args; int narg;
-                ::mrb_get_args(mrb, "*", &args, &narg);
-                // raise error for arg number
-                raise_helper::raisenarg<traits::arity>(mrb, narg);
-                //assert(narg == traits::arity && "bad arguments");
-                DATA_PTR(self) = call_chain<traits::arity>::call<traits>(real_ctor, args);
-                return self;
-            };
-            ::mrb_define_method(mstate, cla, "initialize", initialize_this, MRB_ARGS_REQ(traits::arity));
+            ctor_helper<class_type, T>::bind(mstate, cla, ctor);
             return class_binder<class_type>(mstate);
         }
+        // bind value class, ctor returns object by value, stored inline in ruby object without heap allocation
+        template<typename T> inline auto bind_value(const char* class_name, T ctor) noexcept {
+            return this->bind_value(class_name, ctor, mstate->kernel_module, mstate->object_class);
+        }
+        // bind value class with outer and super
+        template<typename T> inline auto bind_value(const char* class_name, T ctor, RClass* outer, RClass* super) noexcept {
+            using traits = type_helper<T>;
+            using class_type = typename std::decay<typename traits::result_type>::type;
+            static_assert(value_helper<class_type>::value, "trivially copyable type fitting in ISTRUCT_DATA_SIZE only");
+            // define class
+            auto cla = ::mrb_define_class_under(mstate, outer, class_name, super);
+            assert(cla && "error from mruby or bad action");
+            MRB_SET_INSTANCE_TT(cla, MRB_TT_ISTRUCT);
+            state_context::get(mstate).set_class<class_type>(cla);
+            // define initialize method
+            value_ctor_helper<class_type, T>::bind(mstate, cla, ctor);
+            return class_binder<class_type>(mstate);
+        }
+        // fingerprint of every binding in this state
+        auto get_fingerprint() const noexcept { return state_context::get(mstate).get_fingerprint(); }
+        // set native bytes between collections forced by the binder
+        void set_gc_budget(size_t bytes) noexcept { state_context::get(mstate).set_gc_budget(bytes); }
+        // native bytes of bound objects owned by ruby
+        auto get_native_bytes() const noexcept { return state_context::get(mstate).get_native_bytes(); }
+        // mark values held by every bound object with mark hook, call it after c++ stored ruby values
+        void mark_objects() noexcept { state_context::get(mstate).mark_objects(mstate); }
+        // get handle of ruby method, e.g. method<void(float)>(obj, "on_update")
+        template<typename Sig> auto method(const mrb_value& recv, const char* name) const noexcept {
+            return ruby_method<Sig>(mstate, recv, name);
+        }
+#ifdef BINDER_RUBY_PROFILE
+        // snapshot of profile of every binding
+        auto get_profile() const { return state_context::get(mstate).get_profile(); }
+        // reset profile of every binding
+        void reset_profile() noexcept { state_context::get(mstate).reset_profile(); }
+        // dump profile of every binding as text or json
+        auto dump_profile(bool json = false) const { return BindER::dump_profile(this->get_profile(), json); }
+#endif
     private:
         // state of mruby
         mrb_state*              mstate = nullptr;
     };
     // overload for mruby binder
     static inline auto ruby_binder(mrb_state* data) noexcept { return mruby_binder(data); }
+#ifdef BINDER_RUBY_SCRIPT_CACHE
+    // read-only memory mapped file
+    class mapped_file {
+    public:
+        // ctor, map whole file
+        explicit mapped_file(const char* path) noexcept {
+#ifdef _WIN32
+            file = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) return;
+            LARGE_INTEGER len;
+            if (!::GetFileSizeEx(file, &len) || !len.QuadPart) return;
+            mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping) return;
+            const auto ptr = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (!ptr) return;
+            bytes = static_cast<const uint8_t*>(ptr);
+            size = size_t(len.QuadPart);
+#else
+            fd = ::open(path, O_RDONLY);
+            if (fd < 0) return;
+            struct stat st;
+            if (::fstat(fd, &st) || !st.st_size) return;
+            const auto ptr = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr == MAP_FAILED) return;
+            bytes = static_cast<const uint8_t*>(ptr);
+            size = size_t(st.st_size);
+#endif
+        }
+        // dtor
+        ~mapped_file() noexcept {
+#ifdef _WIN32
+            if (bytes) ::UnmapViewOfFile(bytes);
+            if (mapping) ::CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE) ::CloseHandle(file);
+#else
+            if (bytes) ::munmap(const_cast<uint8_t*>(bytes), size);
+            if (fd >= 0) ::close(fd);
+#endif
+        }
+        // no copy
+        mapped_file(const mapped_file&) = delete;
+        // no copy
+        mapped_file& operator=(const mapped_file&) = delete;
+        // data, nullptr if failed
+        auto data() const noexcept { return bytes; }
+        // size in byte
+        auto get_size() const noexcept { return size; }
+    private:
+#ifdef _WIN32
+        // file
+        HANDLE          file = INVALID_HANDLE_VALUE;
+        // mapping
+        HANDLE          mapping = nullptr;
+#else
+        // file
+        int             fd = -1;
+#endif
+        // mapped bytes
+        const uint8_t*  bytes = nullptr;
+        // size in byte
+        size_t          size = 0;
+    };
+    // cache of compiled scripts on disk, keyed by content hash and fingerprint of bindings
+    class script_cache {
+        // header of cache file, followed by RITE binary
+        struct header { char magic[4]; uint32_t version; uint64_t hash; uint64_t fingerprint; uint64_t size; };
+        // version of cache file
+        enum : uint32_t { VERSION = 1 };
+    public:
+        // ctor, files are stored in 'dir'
+        explicit script_cache(std::string dir) noexcept : dir(std::move(dir)) {}
+        // load script, run cached bytecode if valid, otherwise compile, store and run
+        auto load(mrb_state* mrb, const char* script, size_t len) noexcept {
+            const header expected = { 
+                { 'B', 'R', 'B', 'C' }, VERSION, fnv1a(script, len),
+                state_context::get(mrb).get_fingerprint(), 0 
+            };
+            const auto path = this->get_path(expected.hash, expected.fingerprint);
+            // warm: mapped bytecode without parsing, iseq/literals/symbols read in place,
+            // so the mapping is kept by the state until closed, shared by later loads
+            {
+                auto& ctx = state_context::get(mrb);
+                auto file = std::static_pointer_cast<const mapped_file>(ctx.find_mapping(path));
+                if (!script_cache::is_valid(file.get(), expected)) {
+                    file = std::make_shared<const mapped_file>(path.c_str());
+                    if (!script_cache::is_valid(file.get(), expected)) file = nullptr;
+                    else ctx.keep_mapping(path, file);
+                }
+                if (file) {
+                    if (const auto irep = ::mrb_read_irep(mrb, file->data() + sizeof(header))) {
+                        hits.fetch_add(1, std::memory_order_relaxed);
+                        const auto proc = ::mrb_proc_new(mrb, irep);
+                        ::mrb_irep_decref(mrb, irep);
+                        return ::mrb_top_run(mrb, proc, ::mrb_top_self(mrb), 0);
+                    }
+                }
+            }
+            // cold: compile without running
+            misses.fetch_add(1, std::memory_order_relaxed);
+            const auto cxt = ::mrbc_context_new(mrb);
+            cxt->no_exec = TRUE;
+            const auto value = ::mrb_load_nstring_cxt(mrb, script, int(len), cxt);
+            ::mrbc_context_free(mrb, cxt);
+            // syntax error raised as mrb_load_nstring
+            if (mrb->exc || mrb_type(value) != MRB_TT_PROC) return value;
+            const auto proc = mrb_proc_ptr(value);
+            uint8_t* bin = nullptr; size_t bin_size = 0;
+            if (::mrb_dump_irep(mrb, proc->body.irep, 0, &bin, &bin_size) == MRB_DUMP_OK) {
+                auto head = expected;
+                head.size = bin_size;
+                this->store(mrb, path, head, bin);
+                ::mrb_free(mrb, bin);
+            }
+            return ::mrb_top_run(mrb, proc, ::mrb_top_self(mrb), 0);
+        }
+        // load script, run cached bytecode if valid, otherwise compile, store and run
+        auto load(mrb_state* mrb, const char* script) noexcept { return this->load(mrb, script, std::strlen(script)); }
+        // remove cache file of script for bindings of state
+        void remove(mrb_state* mrb, const char* script, size_t len) const noexcept { 
+            std::remove(this->get_path(fnv1a(script, len), state_context::get(mrb).get_fingerprint()).c_str()); 
+        }
+        // count of loads from cache
+        auto get_hits() const noexcept { return hits.load(std::memory_order_relaxed); }
+        // count of loads compiled from source
+        auto get_misses() const noexcept { return misses.load(std::memory_order_relaxed); }
+    private:
+        // header of mapped file matches expected one
+        static bool is_valid(const mapped_file* file, const header& expected) noexcept {
+            header head;
+            if (!file || !file->data() || file->get_size() <= sizeof(head)) return false;
+            std::memcpy(&head, file->data(), sizeof(head));
+            return !std::memcmp(head.magic, expected.magic, sizeof(head.magic)) && head.version == VERSION
+                && head.hash == expected.hash && head.fingerprint == expected.fingerprint
+                && head.size == file->get_size() - sizeof(head);
+        }
+        // path of cache file, named by content hash and fingerprint: states of different bindings never share one
+        auto get_path(uint64_t hash, uint64_t fingerprint) const -> std::string {
+            char name[48];
+            std::snprintf(name, sizeof(name), "/%016llx-%016llx.mrb", (unsigned long long)hash, (unsigned long long)fingerprint);
+            return dir + name;
+        }
+        // write to temp file then rename, readers never see half-written file
+        static void store(mrb_state* mrb, const std::string& path, const header& head, const uint8_t* bin) noexcept {
+            char suffix[32];
+            std::snprintf(suffix, sizeof(suffix), ".%p.tmp", static_cast<void*>(mrb));
+            const auto temp = path + suffix;
+            const auto file = std::fopen(temp.c_str(), "wb");
+            if (!file) return;
+            const bool ok = std::fwrite(&head, sizeof(head), 1, file) == 1
+                && std::fwrite(bin, 1, size_t(head.size), file) == size_t(head.size);
+            std::fclose(file);
+#ifdef _WIN32
+            if (ok) std::remove(path.c_str());
+#endif
+            if (!ok || std::rename(temp.c_str(), path.c_str())) std::remove(temp.c_str());
+        }
+    private:
+        // directory of cache files
+        const std::string           dir;
+        // count of loads from cache
+        std::atomic<size_t>         hits{ 0 };
+        // count of loads compiled from source
+        std::atomic<size_t>         misses{ 0 };
+    };
+#endif
+#ifdef BINDER_RUBY_WORKER_POOL
+    // worker pool, every thread owns one mruby state bound by the same init function
+    class worker_pool {
+    public:
+        // init function, bind everything to new state
+        using init_func = std::function<void(mrb_state*)>;
+        // job function, run on any worker's state
+        using job_func = std::function<void(mrb_state*)>;
+        // ctor, start 'count' threads, 0 for hardware concurrency
+        worker_pool(size_t count, init_func init) : init(std::move(init)) {
+            if (!count) count = std::max(1u, std::thread::hardware_concurrency());
+            threads.reserve(count);
+            for (size_t i = 0; i != count; ++i) threads.emplace_back([this]() noexcept { this->work(); });
+            // wait for every state ready
+            std::unique_lock<std::mutex> lock(mutex);
+            idle_cv.wait(lock, [this, count]() noexcept { return ready == count; });
+        }
+        // dtor, finish queued jobs, close states and join threads
+        ~worker_pool() noexcept {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            job_cv.notify_all();
+            for (auto& thread : threads) thread.join();
+        }
+        // no copy
+        worker_pool(const worker_pool&) = delete;
+        // no copy
+        worker_pool& operator=(const worker_pool&) = delete;
+        // submit job
+        void submit(job_func job) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                jobs.push_back(std::move(job));
+                ++pending;
+            }
+            job_cv.notify_one();
+        }
+        // submit script
+        void submit_script(std::string script) {
+            this->submit([script = std::move(script)](mrb_state* mrb) noexcept { ::mrb_load_string(mrb, script.c_str()); });
+        }
+        // wait until every submitted job done
+        void wait() noexcept {
+            std::unique_lock<std::mutex> lock(mutex);
+            idle_cv.wait(lock, [this]() noexcept { return pending == 0; });
+        }
+        // count of threads
+        auto get_count() const noexcept { return threads.size(); }
+        // count of jobs raised exception
+        auto get_errors() const noexcept { return errors.load(std::memory_order_relaxed); }
+    private:
+        // worker thread
+        void work() noexcept {
+            const auto mrb = ::mrb_open();
+            assert(mrb && "out of memory");
+            init(mrb);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++ready;
+            }
+            idle_cv.notify_all();
+            while (true) {
+                job_func job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    job_cv.wait(lock, [this]() noexcept { return stopping || !jobs.empty(); });
+                    if (jobs.empty()) break;
+                    job = std::move(jobs.front());
+                    jobs.pop_front();
+                }
+                const auto ai = ::mrb_gc_arena_save(mrb);
+                job(mrb);
+                ::mrb_gc_arena_restore(mrb, ai);
+                if (mrb->exc) {
+                    mrb->exc = nullptr;
+                    errors.fetch_add(1, std::memory_order_relaxed);
+                }
+                bool idle;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    idle = --pending == 0;
+                }
+                if (idle) idle_cv.notify_all();
+            }
+            ::mrb_close(mrb);
+        }
+    private:
+        // init function
+        const init_func             init;
+        // threads
+        std::vector<std::thread>    threads;
+        // mutex for queue
+        std::mutex                  mutex;
+        // cv for new job
+        std::condition_variable     job_cv;
+        // cv for ready/idle
+        std::condition_variable     idle_cv;
+        // queue of jobs
+        std::deque<job_func>        jobs;
+        // count of jobs not done
+        size_t                      pending = 0;
+        // count of ready states
+        size_t                      ready = 0;
+        // count of jobs raised exception
+        std::atomic<size_t>         errors{ 0 };
+        // stop flag
+        bool                        stopping = false;
+    };
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,843 @@
+// worker pool for throughput bench
+#define BINDER_RUBY_WORKER_POOL
+// script cache for startup bench
+#define BINDER_RUBY_SCRIPT_CACHE
+// fiber-suspending bindings for async bench
+#define BINDER_RUBY_ASYNC
+#include "../bindenvruby.h"
+#include <mruby/compile.h>
+#include <mruby/variable.h>
+#include <initializer_list>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <new>
+
+// ----------------------------------------------------------------------------
+// allocation counter, mruby allocf + global operator new
+// ----------------------------------------------------------------------------
+
+// count of allocations, worker threads allocate too
+static std::atomic<size_t> g_allocs{ 0 };
+
+// operator new
+void* operator new(size_t size) {
+    ++g_allocs;
+    if (const auto ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+// operator new nothrow
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    ++g_allocs;
+    return std::malloc(size ? size : 1);
+}
+// operator delete
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+// operator delete nothrow
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+// operator delete sized
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+// mruby allocator
+static void* bench_allocf(mrb_state*, void* ptr, size_t size, void*) {
+    if (!size) { std::free(ptr); return nullptr; }
+    ++g_allocs;
+    return std::realloc(ptr, size);
+}
+
+// ----------------------------------------------------------------------------
+// bound by BindER
+// ----------------------------------------------------------------------------
+
+// max arity
+enum : size_t { BENCH_MAX_ARITY = 8 };
+
+class Bench {
+public:
+    // sum
+    int32_t sum = 0;
+    // fields
+    float x = 0.f, y = 0.f, z = 0.f, w = 0.f;
+};
+
+// object created by ctor with arity N
+template<size_t N> class BenchCtor {
+public:
+    // sum
+    int32_t sum = 0;
+};
+
+// object created in slab pool
+class BenchPooled {
+public:
+    // ctor
+    BenchPooled(int32_t sum) noexcept : sum(sum) {}
+    // sum
+    int32_t sum = 0;
+};
+
+// small math type, stored inline by bind_value if 'Inline', heap by bind_class otherwise
+template<bool Inline> struct BenchVec { float x, y, z; };
+// passed by value
+namespace BindER { template<bool Inline> struct value_class<BenchVec<Inline>> : std::true_type {}; }
+
+// native buffer behind wrapper, size reported to gc if 'Sized'
+template<bool Sized> class BenchBlob {
+public:
+    // size of buffer
+    enum : size_t { SIZE = 256 << 10 };
+    // ctor
+    BenchBlob() : data(SIZE) { 
+        const auto n = ++live; auto p = peak.load(); 
+        while (n > p && !peak.compare_exchange_weak(p, n)); 
+    }
+    // dtor
+    ~BenchBlob() noexcept { --live; }
+    // buffer
+    std::vector<char> data;
+    // live and peak count
+    static std::atomic<size_t> live, peak;
+};
+template<bool Sized> std::atomic<size_t> BenchBlob<Sized>::live{ 0 };
+template<bool Sized> std::atomic<size_t> BenchBlob<Sized>::peak{ 0 };
+
+// repeat type for index
+template<size_t, typename T> using repeat_t = T;
+
+// sum of arguments
+static inline int32_t sum_of() noexcept { return 0; }
+// sum of arguments
+template<typename... Args>
+static inline int32_t sum_of(int32_t a, Args... args) noexcept { return a + sum_of(args...); }
+
+// instance method with arity N
+template<typename Seq> struct bench_method;
+template<size_t... I> struct bench_method<std::index_sequence<I...>> {
+    auto operator()(Bench* obj, repeat_t<I, int32_t>... args) const noexcept {
+        return obj->sum += sum_of(args...);
+    }
+};
+
+// class method with arity N
+template<typename Seq> struct bench_function;
+template<size_t... I> struct bench_function<std::index_sequence<I...>> {
+    auto operator()(repeat_t<I, int32_t>... args) const noexcept { return sum_of(args...); }
+};
+
+// ctor with arity N
+template<typename Seq> struct bench_ctor;
+template<size_t... I> struct bench_ctor<std::index_sequence<I...>> {
+    auto operator()(repeat_t<I, int32_t>... args) const noexcept {
+        const auto obj = new(std::nothrow) BenchCtor<sizeof...(I)>();
+        if (obj) obj->sum = sum_of(args...);
+        return obj;
+    }
+};
+
+// bind arity N
+template<size_t N>
+static void binder_arity(BindER::mruby_binder& binder, BindER::mruby_binder::class_binder<Bench>& bbinder) {
+    using seq = std::make_index_sequence<N>;
+    const auto name = std::to_string(N);
+    bbinder.bind(("m" + name).c_str(), bench_method<seq>());
+    bbinder.bind(("c" + name).c_str(), bench_function<seq>());
+    binder.bind_class(("Ctor" + name).c_str(), bench_ctor<seq>());
+}
+
+// bind arity 0 - BENCH_MAX_ARITY
+template<size_t... I>
+static void binder_arity(BindER::mruby_binder& binder, BindER::mruby_binder::class_binder<Bench>& bbinder, std::index_sequence<I...>) {
+    (void)std::initializer_list<int>{ (binder_arity<I>(binder, bbinder), 0)... };
+}
+
+// cached handle of $handler.cb for callback bench, main state only
+static BindER::ruby_method<int32_t(int32_t)>* g_handler = nullptr;
+
+// read whole file for async bench
+static std::string read_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream ss; ss << file.rdbuf();
+    return ss.str();
+}
+
+// bind all
+static void binder_bench(mrb_state* mruby) {
+    auto binder = BindER::ruby_binder(mruby);
+    auto bbinder = binder.bind_class("Bench", []() noexcept {
+        return new(std::nothrow) Bench();
+    });
+    // every ruby_arg
+    bbinder.bind("t_int32", [](Bench*, int32_t v) noexcept { return v; });
+    bbinder.bind("t_uint32", [](Bench*, uint32_t v) noexcept { return v; });
+    bbinder.bind("t_float", [](Bench*, float v) noexcept { return v; });
+    bbinder.bind("t_double", [](Bench*, double v) noexcept { return v; });
+    bbinder.bind("t_bool", [](Bench*, bool v) noexcept { return v; });
+    bbinder.bind("t_string", [](Bench*, const char* v) noexcept { return v; });
+    bbinder.bind("t_pointer", [](Bench*, void* v) noexcept { return v; });
+    bbinder.bind("t_bytes", [](Bench*, BindER::span<const char> v) noexcept { return v; });
+    bbinder.bind("t_static", [](Bench*, int32_t) noexcept { using namespace BindER::literals; return "binder"_static; });
+    // containers
+    bbinder.bind("t_floats", [](Bench* obj, BindER::span<const float> v) noexcept { 
+        float sum = 0.f; for (auto x : v) sum += x; obj->sum = int32_t(sum); 
+    });
+    bbinder.bind("t_ints", [](Bench* obj, const std::vector<int32_t>& v) noexcept { 
+        int32_t sum = 0; for (auto x : v) sum += x; obj->sum = sum; 
+    });
+    bbinder.bind("t_make", [](Bench*, int32_t n) noexcept { 
+        std::vector<float> v(static_cast<size_t>(n)); for (size_t i = 0; i != v.size(); ++i) v[i] = float(i); return v;
+    });
+    bbinder.bind("t_lazy", [](Bench*, int32_t n) noexcept { 
+        return BindER::generator<float>([i = 0, n](float& v) mutable noexcept { if (i == n) return false; v = float(i++); return true; });
+    });
+    bbinder.bind("t_original", [](Bench* obj, int32_t v) noexcept {
+        obj->sum = v; return BindER::original_parameter<0>();
+    });
+    bbinder.bind("pointer", []() noexcept { return static_cast<void*>(nullptr); });
+    bbinder.bind("t_self", [](Bench* obj) noexcept { return obj; });
+    // overload set
+    bbinder.bind_overload("over", 
+        [](Bench*, int32_t v) noexcept { return v; },
+        [](Bench*, const char* v) noexcept { return v; },
+        [](Bench*, int32_t a, int32_t b) noexcept { return a + b; }
+    );
+    // fields
+    bbinder.bind_attr("x", &Bench::x);
+    bbinder.bind_attr("y", &Bench::y);
+    bbinder.bind_attr("z", &Bench::z);
+    bbinder.bind_attr("w", &Bench::w);
+    // batch variant
+    bbinder.bind("t_send", [](Bench*, int32_t n) noexcept {
+        int32_t sum = 0; for (int32_t i = 0; i != n; ++i) sum += (*g_handler)(i); return sum;
+    });
+    bbinder.bind("t_yield", [](Bench*, int32_t n, BindER::ruby_proc<int32_t(int32_t)> blk) noexcept {
+        int32_t sum = 0; for (int32_t i = 0; i != n; ++i) sum += blk(i); return sum;
+    });
+    bbinder.bind_batch("t_batch", [](Bench* obj, int32_t v) noexcept { obj->sum += v; return obj->sum; });
+    bbinder.bind_batch("t_mul", [](int32_t a, int32_t b) noexcept { return a * b; });
+    bbinder.bind_batch("t_tick", [](Bench* obj, int32_t v) noexcept { obj->sum += v; }, BindER::batch_mode::discard);
+    // async on pool against blocking the state's thread
+    bbinder.bind_async("a_sleep", [](int32_t ms) noexcept { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); });
+    bbinder.bind("s_sleep", [](int32_t ms) noexcept { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); });
+    bbinder.bind_async("a_read", [](const std::string& path) { return read_file(path); });
+    bbinder.bind("s_read", [](const char* path) { return read_file(path); });
+    // every arity
+    binder_arity(binder, bbinder, std::make_index_sequence<BENCH_MAX_ARITY + 1>());
+    // value class against heap class
+    auto vbinder = binder.bind_value("Vec", [](float x, float y, float z) noexcept { return BenchVec<true>{ x, y, z }; });
+    vbinder.bind("add", [](const BenchVec<true>* a, const BenchVec<true>& b) noexcept { 
+        return BenchVec<true>{ a->x + b.x, a->y + b.y, a->z + b.z }; 
+    });
+    vbinder.bind_attr("x", &BenchVec<true>::x);
+    auto hbinder = binder.bind_class("HeapVec", [](float x, float y, float z) noexcept { 
+        return new(std::nothrow) BenchVec<false>{ x, y, z }; 
+    });
+    hbinder.bind("add", [](const BenchVec<false>* a, const BenchVec<false>& b) noexcept { 
+        return BenchVec<false>{ a->x + b.x, a->y + b.y, a->z + b.z }; 
+    });
+    hbinder.bind_attr("x", &BenchVec<false>::x);
+    // native memory, sized one charged to gc pacing
+    binder.bind_class("SizedBlob", []() noexcept { return new(std::nothrow) BenchBlob<true>; })
+        .set_gc_size(sizeof(BenchBlob<true>) + BenchBlob<true>::SIZE);
+    binder.bind_class("Blob", []() noexcept { return new(std::nothrow) BenchBlob<false>; });
+    // slab pool
+    binder.bind_class("PoolCtor3", [](BindER::pool_slot<BenchPooled> slot, int32_t a, int32_t b, int32_t c) noexcept {
+        return slot.construct(a + b + c);
+    });
+}
+
+// ----------------------------------------------------------------------------
+// handwritten by mruby c-api
+// ----------------------------------------------------------------------------
+
+// data type for raw object
+static const mrb_data_type raw_type = {
+    "RawBench", [](mrb_state*, void* ptr) { delete static_cast<Bench*>(ptr); }
+};
+
+// char for index
+template<size_t> constexpr char char_of(char ch) { return ch; }
+
+// get N fixnum, return sum
+template<size_t... I>
+static int32_t raw_sum(mrb_state* mrb, std::index_sequence<I...>) {
+    static const char format[] = { char_of<I>('i')..., 0 };
+    mrb_int args[sizeof...(I) + 1] = { 0 };
+    ::mrb_get_args(mrb, format, &args[I]...);
+    int32_t sum = 0;
+    for (size_t i = 0; i != sizeof...(I); ++i) sum += int32_t(args[i]);
+    return sum;
+}
+
+// instance method with arity N
+template<size_t N>
+static mrb_value raw_method(mrb_state* mrb, mrb_value self) {
+    const auto obj = static_cast<Bench*>(DATA_PTR(self));
+    obj->sum += raw_sum(mrb, std::make_index_sequence<N>());
+    return ::mrb_fixnum_value(obj->sum);
+}
+
+// class method with arity N
+template<size_t N>
+static mrb_value raw_function(mrb_state* mrb, mrb_value) {
+    return ::mrb_fixnum_value(raw_sum(mrb, std::make_index_sequence<N>()));
+}
+
+// ctor with arity N
+template<size_t N>
+static mrb_value raw_initialize(mrb_state* mrb, mrb_value self) {
+    DATA_TYPE(self) = &raw_type;
+    DATA_PTR(self) = nullptr;
+    const auto sum = raw_sum(mrb, std::make_index_sequence<N>());
+    const auto obj = new(std::nothrow) Bench();
+    if (obj) obj->sum = sum;
+    DATA_PTR(self) = obj;
+    return self;
+}
+
+// getter of field
+template<float Bench::* M>
+static mrb_value raw_getter(mrb_state* mrb, mrb_value self) {
+    return ::mrb_float_value(mrb, static_cast<Bench*>(DATA_PTR(self))->*M);
+}
+
+// setter of field
+template<float Bench::* M>
+static mrb_value raw_setter(mrb_state* mrb, mrb_value self) {
+    mrb_float v; ::mrb_get_args(mrb, "f", &v);
+    static_cast<Bench*>(DATA_PTR(self))->*M = float(v);
+    return ::mrb_float_value(mrb, v);
+}
+
+// define getter and setter of field
+template<float Bench::* M>
+static void raw_field(mrb_state* mrb, RClass* cla, const char* name) {
+    ::mrb_define_method(mrb, cla, name, raw_getter<M>, MRB_ARGS_NONE());
+    ::mrb_define_method(mrb, cla, (std::string(name) + "=").c_str(), raw_setter<M>, MRB_ARGS_REQ(1));
+}
+
+// define arity N
+template<size_t N>
+static void raw_arity(mrb_state* mrb, RClass* cla) {
+    const auto name = std::to_string(N);
+    ::mrb_define_method(mrb, cla, ("m" + name).c_str(), raw_method<N>, MRB_ARGS_REQ(N));
+    ::mrb_define_class_method(mrb, cla, ("c" + name).c_str(), raw_function<N>, MRB_ARGS_REQ(N));
+    const auto ctor = ::mrb_define_class(mrb, ("RawCtor" + name).c_str(), mrb->object_class);
+    MRB_SET_INSTANCE_TT(ctor, MRB_TT_DATA);
+    ::mrb_define_method(mrb, ctor, "initialize", raw_initialize<N>, MRB_ARGS_REQ(N));
+}
+
+// define arity 0 - BENCH_MAX_ARITY
+template<size_t... I>
+static void raw_arity(mrb_state* mrb, RClass* cla, std::index_sequence<I...>) {
+    (void)std::initializer_list<int>{ (raw_arity<I>(mrb, cla), 0)... };
+}
+
+// define all
+static void raw_bench(mrb_state* mrb) {
+    const auto cla = ::mrb_define_class(mrb, "RawBench", mrb->object_class);
+    MRB_SET_INSTANCE_TT(cla, MRB_TT_DATA);
+    ::mrb_define_method(mrb, cla, "initialize", raw_initialize<0>, MRB_ARGS_NONE());
+    ::mrb_define_method(mrb, cla, "t_int32", [](mrb_state* mrb, mrb_value) {
+        mrb_int v; ::mrb_get_args(mrb, "i", &v);
+        return ::mrb_fixnum_value(int32_t(v));
+    }, MRB_ARGS_REQ(1));
+    ::mrb_define_method(mrb, cla, "t_uint32", [](mrb_state* mrb, mrb_value) {
+        mrb_int v; ::mrb_get_args(mrb, "i", &v);
+        return ::mrb_fixnum_value(uint32_t(v));
+    }, MRB_ARGS_REQ(1));
+    ::mrb_define_method(mrb, cla, "t_float", [](mrb_state* mrb, mrb_value) {
+        mrb_float v; ::mrb_get_args(mrb, "f", &v);
+        return ::mrb_float_value(mrb, float(v));
+    }, MRB_ARGS_REQ(1));
+    ::mrb_define_method(mrb, cla, "t_double", [](mrb_state* mrb, mrb_value) {
+        mrb_float v; ::mrb_get_args(mrb, "f", &v);
+        return ::mrb_float_value(mrb, double(v));
+    }, MRB_ARGS_REQ(1));
+    ::mrb_define_method(mrb, cla, "t_bool", [](mrb_state* mrb, mrb_value) {
+        mrb_bool v; ::mrb_get_args(mrb, "b", &v);
+        return ::mrb_bool_value(v);
+    }, MRB_ARGS_REQ(1));
+    ::mrb_define_method(mrb, cla, "t_string", [](mrb_state* mrb, mrb_value) {
+        char* v; ::mrb_get_args(mrb, "z", &v);
+        return ::mrb_str_new_cstr(mrb, v);
+    }, MRB_ARGS_REQ(1));
+    ::mrb_define_method(mrb, cla, "t_self", [](mrb_state*, mrb_value self) { return self; }, MRB_ARGS_NONE());
+    ::mrb_define_method(mrb, cla, "over", [](mrb_state* mrb, mrb_value) {
+        mrb_value* v; mrb_int n; ::mrb_get_args(mrb, "*", &v, &n);
+        if (n == 1 && mrb_fixnum_p(v[0])) return v[0];
+        if (n == 1 && mrb_string_p(v[0])) return ::mrb_str_new_cstr(mrb, RSTRING_PTR(v[0]));
+        if (n == 2 && mrb_fixnum_p(v[0]) && mrb_fixnum_p(v[1])) return ::mrb_fixnum_value(mrb_fixnum(v[0]) + mrb_fixnum(v[1]));
+        ::mrb_raise(mrb, E_ARGUMENT_ERROR, "no overload matches arguments");
+        return ::mrb_nil_value();
+    }, MRB_ARGS_ANY());
+    ::mrb_define_method(mrb, cla, "t_pointer", [](mrb_state* mrb, mrb_value) {
+        mrb_value v; ::mrb_get_args(mrb, "o", &v);
+        return ::mrb_cptr_value(mrb, mrb_cptr(v));
+    }, MRB_ARGS_REQ(1));
+    ::mrb_define_method(mrb, cla, "t_bytes", [](mrb_state* mrb, mrb_value) {
+        char* v; mrb_int len; ::mrb_get_args(mrb, "s", &v, &len);
+        return ::mrb_str_new(mrb, v, size_t(len));
+    }, MRB_ARGS_REQ(1));
+    ::mrb_define_method(mrb, cla, "t_static", [](mrb_state* mrb, mrb_value) {
+        mrb_int v; ::mrb_get_args(mrb, "i", &v);
+        return ::mrb_str_new_static(mrb, "binder", 6);
+    }, MRB_ARGS_REQ(1));
+    ::mrb_define_method(mrb, cla, "t_original", [](mrb_state* mrb, mrb_value self) {
+        mrb_value v; ::mrb_get_args(mrb, "o", &v);
+        static_cast<Bench*>(DATA_PTR(self))->sum = int32_t(mrb_fixnum(v));
+        return v;
+    }, MRB_ARGS_REQ(1));
+    ::mrb_define_method(mrb, cla, "t_send", [](mrb_state* mrb, mrb_value) {
+        mrb_int n; ::mrb_get_args(mrb, "i", &n);
+        const auto handler = ::mrb_gv_get(mrb, mrb_intern_lit(mrb, "$handler"));
+        mrb_int sum = 0;
+        for (mrb_int i = 0; i != n; ++i) sum += mrb_fixnum(::mrb_funcall(mrb, handler, "cb", 1, ::mrb_fixnum_value(i)));
+        return ::mrb_fixnum_value(sum);
+    }, MRB_ARGS_REQ(1));
+    ::mrb_define_method(mrb, cla, "t_yield", [](mrb_state* mrb, mrb_value) {
+        mrb_int n; mrb_value blk; ::mrb_get_args(mrb, "io", &n, &blk);
+        mrb_int sum = 0;
+        for (mrb_int i = 0; i != n; ++i) sum += mrb_fixnum(::mrb_yield(mrb, blk, ::mrb_fixnum_value(i)));
+        return ::mrb_fixnum_value(sum);
+    }, MRB_ARGS_REQ(2));
+    raw_arity(mrb, cla, std::make_index_sequence<BENCH_MAX_ARITY + 1>());
+    raw_field<&Bench::x>(mrb, cla, "x");
+    raw_field<&Bench::y>(mrb, cla, "y");
+    raw_field<&Bench::z>(mrb, cla, "z");
+    raw_field<&Bench::w>(mrb, cla, "w");
+}
+
+// ----------------------------------------------------------------------------
+// runner
+// ----------------------------------------------------------------------------
+
+// one measurement
+struct bench_sample { double ns; double allocs; };
+
+// one result
+struct bench_result {
+    // group/name
+    std::string     group, name;
+    // BindER/handwritten
+    bench_sample    binder, raw;
+};
+
+// runner
+class bench_runner {
+public:
+    // ctor
+    bench_runner(mrb_state* mrb, int loop) noexcept : mrb(mrb), loop(loop) {
+        const auto sample = this->run_raw("nil", loop);
+        baseline = { sample.ns / double(loop), sample.allocs / double(loop) };
+    }
+    // run 'call' in a loop, return cost per call
+    auto run(const std::string& call, int count) noexcept {
+        const auto sample = this->run_raw(call, count);
+        return bench_sample{
+            sample.ns / double(count) - baseline.ns,
+            sample.allocs / double(count) - baseline.allocs
+        };
+    }
+    // run setup script without timing, share data by global variables
+    void setup(const char* script) noexcept {
+        ::mrb_load_string(mrb, script);
+        if (mrb->exc) {
+            std::fprintf(stderr, "setup raised\n");
+            mrb->exc = nullptr;
+        }
+    }
+    // add result
+    void add(const char* group, const std::string& name, const std::string& binder, const std::string& raw) {
+        this->add(group, name, binder, raw, loop);
+    }
+    // add result with loop count
+    void add(const char* group, const std::string& name, const std::string& binder, const std::string& raw, int count) {
+        results.push_back({ group, name, this->run(binder, count), this->run(raw, count) });
+    }
+    // add result measured outside
+    void add(const char* group, const std::string& name, const bench_sample& binder, const bench_sample& raw) {
+        results.push_back({ group, name, binder, raw });
+    }
+    // get results
+    auto& get_results() const noexcept { return results; }
+private:
+    // run 'call' in a loop, return total cost
+    bench_sample run_raw(const std::string& call, int count) noexcept {
+        std::string script =
+            "o = Bench.new\n"
+            "r = RawBench.new\n"
+            "p = Bench.pointer\n"
+            "i = 0\n"
+            "while i < ";
+        script += std::to_string(count);
+        script += "\n  ";
+        script += call;
+        script += "\n  i += 1\nend\n";
+        const auto allocs = g_allocs.load();
+        const auto begin = std::chrono::high_resolution_clock::now();
+        ::mrb_load_string(mrb, script.c_str());
+        const auto end = std::chrono::high_resolution_clock::now();
+        if (mrb->exc) {
+            std::fprintf(stderr, "script raised: %s\n", call.c_str());
+            mrb->exc = nullptr;
+        }
+        return bench_sample{
+            double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()),
+            double(g_allocs - allocs)
+        };
+    }
+private:
+    // mruby
+    mrb_state*                  mrb;
+    // loop count
+    int                         loop;
+    // empty loop
+    bench_sample                baseline;
+    // results
+    std::vector<bench_result>   results;
+};
+
+// run 'jobs' scripts on worker pool with 'threads' threads, return cost per job
+static auto run_workers(size_t threads, size_t jobs) {
+    BindER::worker_pool pool(threads, [](mrb_state* mrb) { binder_bench(mrb); });
+    const auto allocs = g_allocs.load();
+    const auto begin = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i != jobs; ++i) {
+        pool.submit_script("o = Bench.new\ni = 0\nwhile i < 100000\n  o.m1 1\n  i += 1\nend\n");
+    }
+    pool.wait();
+    const auto end = std::chrono::high_resolution_clock::now();
+    if (pool.get_errors()) std::fprintf(stderr, "worker script raised\n");
+    return bench_sample{
+        double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()) / double(jobs),
+        double(g_allocs.load() - allocs) / double(jobs)
+    };
+}
+
+// script for startup bench, many small methods
+static auto make_startup_script() {
+    std::string script;
+    for (size_t i = 0; i != 2000; ++i) {
+        const auto n = std::to_string(i);
+        script += "def f" + n + "(o, x)\n  o.m1(x + " + n + ")\n  [x, " + n + "].max\nend\n";
+    }
+    script += "o = Bench.new\nf0(o, 1)\n";
+    return script;
+}
+
+// start 'count' states: open, bind and load script, by cache if given, return cost per start
+static auto run_startup(const std::string& script, BindER::script_cache* cache, int count) {
+    double ns = 0, allocs = 0;
+    for (int i = 0; i != count; ++i) {
+        const auto allocs0 = g_allocs.load();
+        const auto begin = std::chrono::high_resolution_clock::now();
+        const auto mrb = ::mrb_open_allocf(bench_allocf, nullptr);
+        binder_bench(mrb);
+        if (cache) cache->load(mrb, script.c_str(), script.size());
+        else ::mrb_load_nstring(mrb, script.c_str(), int(script.size()));
+        const auto end = std::chrono::high_resolution_clock::now();
+        if (mrb->exc) std::fprintf(stderr, "startup script raised\n");
+        ns += double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+        allocs += double(g_allocs.load() - allocs0);
+        ::mrb_close(mrb);
+    }
+    return bench_sample{ ns / double(count), allocs / double(count) };
+}
+
+// count of methods for init bench
+enum : size_t { WIDE_METHODS = 5000 };
+
+// method of wide class, 8 functions shared by every name
+template<size_t I> static int32_t wide_method(Bench* obj, int32_t v) noexcept { return obj->sum += v + int32_t(I); }
+
+// names of wide methods, "w0" - "w4999"
+static const auto& wide_names() {
+    static std::vector<std::string> names;
+    for (size_t i = names.size(); i != WIDE_METHODS; ++i) names.push_back("w" + std::to_string(i));
+    return names;
+}
+
+// binding table of wide methods
+template<size_t... I> static auto make_wide_table(std::index_sequence<I...>) {
+    static constexpr BindER::method_entry funcs[] = { 
+        BindER::table_method<Bench, decltype(&wide_method<I>), &wide_method<I>>(nullptr)... 
+    };
+    std::vector<BindER::method_entry> table;
+    for (size_t i = 0; i != WIDE_METHODS; ++i) {
+        table.push_back(funcs[i % sizeof...(I)]);
+        table.back().name = wide_names()[i].c_str();
+    }
+    return table;
+}
+
+// how wide methods are bound
+enum class wide_mode { bind, table, lazy, raw };
+
+// open 'count' states: bind class 'Wide' with WIDE_METHODS methods by 'mode' and call 3 of them, return cost per state
+static auto run_init(wide_mode mode, int count) {
+    static const auto table = make_wide_table(std::make_index_sequence<8>());
+    double ns = 0, allocs = 0;
+    for (int i = 0; i != count; ++i) {
+        const auto allocs0 = g_allocs.load();
+        const auto begin = std::chrono::high_resolution_clock::now();
+        const auto mrb = ::mrb_open_allocf(bench_allocf, nullptr);
+        if (mode == wide_mode::raw) {
+            const auto cla = ::mrb_define_class(mrb, "Wide", mrb->object_class);
+            MRB_SET_INSTANCE_TT(cla, MRB_TT_DATA);
+            ::mrb_define_method(mrb, cla, "initialize", raw_initialize<0>, MRB_ARGS_NONE());
+            for (const auto& name : wide_names()) ::mrb_define_method(mrb, cla, name.c_str(), raw_method<1>, MRB_ARGS_REQ(1));
+        }
+        else {
+            auto wbinder = BindER::ruby_binder(mrb).bind_class("Wide", []() noexcept { return new(std::nothrow) Bench; });
+            if (mode == wide_mode::bind) {
+                for (const auto& name : wide_names()) {
+                    wbinder.bind(name.c_str(), [](Bench* obj, int32_t v) noexcept { return obj->sum += v; });
+                }
+            }
+            else wbinder.bind_table(table.data(), table.size(), mode == wide_mode::lazy);
+        }
+        ::mrb_load_string(mrb, "o = Wide.new\no.w0 1\no.w2500 1\no.w4999 1\n");
+        const auto end = std::chrono::high_resolution_clock::now();
+        if (mrb->exc) std::fprintf(stderr, "init script raised\n");
+        ns += double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+        allocs += double(g_allocs.load() - allocs0);
+        ::mrb_close(mrb);
+    }
+    return bench_sample{ ns / double(count), allocs / double(count) };
+}
+
+// run 'script' then resume fibers until every async call done, return cost per run
+static auto run_async(mrb_state* mrb, BindER::async_loop& loop, const std::string& script, int count) {
+    const auto allocs = g_allocs.load();
+    const auto begin = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i != count; ++i) {
+        const auto ai = ::mrb_gc_arena_save(mrb);
+        ::mrb_load_string(mrb, script.c_str());
+        loop.run();
+        ::mrb_gc_arena_restore(mrb, ai);
+    }
+    const auto end = std::chrono::high_resolution_clock::now();
+    if (mrb->exc || loop.get_errors()) std::fprintf(stderr, "async script raised\n");
+    return bench_sample{
+        double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()) / double(count),
+        double(g_allocs.load() - allocs) / double(count)
+    };
+}
+
+// cache dir for startup bench
+static auto get_cache_dir() {
+#ifdef _WIN32
+    const auto dir = std::getenv("TEMP");
+    return std::string(dir ? dir : ".");
+#else
+    const auto dir = std::getenv("TMPDIR");
+    return std::string(dir ? dir : "/tmp");
+#endif
+}
+
+// arguments "1, 2, ... n"
+static auto make_args(size_t n) {
+    std::string args;
+    for (size_t i = 0; i != n; ++i) {
+        if (i) args += ", ";
+        args += std::to_string(i + 1);
+    }
+    return args;
+}
+
+// print as text
+static void print_text(const std::vector<bench_result>& results) {
+    std::printf("%-10s %-12s %12s %12s %10s %10s\n",
+        "group", "case", "binder ns", "raw ns", "binder alc", "raw alc"
+    );
+    for (const auto& r : results) {
+        std::printf("%-10s %-12s %12.2f %12.2f %10.3f %10.3f\n",
+            r.group.c_str(), r.name.c_str(),
+            r.binder.ns, r.raw.ns, r.binder.allocs, r.raw.allocs
+        );
+    }
+}
+
+// print as json
+static void print_json(const std::vector<bench_result>& results, const char* args_mode, int loop) {
+    std::printf("{\n  \"args\": \"%s\",\n  \"loop\": %d,\n  \"results\": [\n", args_mode, loop);
+    for (size_t i = 0; i != results.size(); ++i) {
+        const auto& r = results[i];
+        std::printf(
+            "    { \"group\": \"%s\", \"case\": \"%s\", "
+            "\"binder_ns\": %.3f, \"raw_ns\": %.3f, "
+            "\"binder_allocs\": %.4f, \"raw_allocs\": %.4f }%s\n",
+            r.group.c_str(), r.name.c_str(),
+            r.binder.ns, r.raw.ns, r.binder.allocs, r.raw.allocs,
+            i + 1 == results.size() ? "" : ","
+        );
+    }
+    std::printf("  ]\n}\n");
+}
+
+// main, bench [--json] [--loop N]
+int main(int argc, char* argv[]) {
+    bool json = false; int loop = 1000000;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--json")) json = true;
+        else if (!std::strcmp(argv[i], "--loop") && i + 1 < argc) loop = std::atoi(argv[++i]);
+    }
+#ifdef BINDER_RUBY_FAST_ARGS
+    const auto args_mode = "fast";
+#else
+    const auto args_mode = "mrb_get_args";
+#endif
+    auto mruby = ::mrb_open_allocf(bench_allocf, nullptr);
+    if (!mruby) return -1;
+    binder_bench(mruby);
+    raw_bench(mruby);
+    bench_runner runner(mruby, loop);
+    // every arity
+    for (size_t n = 0; n <= BENCH_MAX_ARITY; ++n) {
+        const auto name = std::to_string(n);
+        const auto args = " " + make_args(n);
+        runner.add("instance", "arity" + name, "o.m" + name + args, "r.m" + name + args);
+        runner.add("class", "arity" + name, "Bench.c" + name + args, "RawBench.c" + name + args);
+        runner.add("ctor", "arity" + name, "Ctor" + name + ".new" + args, "RawCtor" + name + ".new" + args);
+    }
+    // slab pool against bind_class with new/delete, both columns are BindER
+    runner.add("pool", "arity3", "PoolCtor3.new 1, 2, 3", "Ctor3.new 1, 2, 3");
+    // 100k-element array in one call against one call per element
+    runner.setup(
+        "$floats = Array.new(100000) { |i| i * 0.5 }\n"
+        "$ints = Array.new(100000) { |i| i }\n"
+    );
+    runner.add("array", "floats", "o.t_floats $floats", "$floats.each { |x| o.t_float x }", 100);
+    runner.add("array", "ints", "o.t_ints $ints", "$ints.each { |x| o.t_int32 x }", 100);
+    runner.add("array", "make", "o.t_make 100000", "Array.new(100000) { |x| o.t_float x }", 100);
+    // lazy sequence pulled on demand against building the whole array
+    runner.add("lazy", "first", "o.t_lazy(100000).first 10", "o.t_make(100000).first 10", 100);
+    runner.add("lazy", "each", "o.t_lazy(100000).each { |x| x }", "o.t_make(100000).each { |x| x }", 100);
+    // batch variant against one call per object
+    runner.setup(
+        "$objs = Array.new(10000) { Bench.new }\n"
+        "$pairs = Array.new(10000) { |i| [i, 2] }\n"
+    );
+    runner.add("batch", "receivers", "Bench.t_batch_each $objs, 1", "$objs.each { |x| x.t_batch 1 }", 1000);
+    runner.add("batch", "discard", "Bench.t_tick_each $objs, 1", "$objs.each { |x| x.t_tick 1 }", 1000);
+    runner.add("batch", "tuples", "Bench.t_mul_each $pairs", "$pairs.each { |a, b| Bench.t_mul a, b }", 1000);
+    // member-pointer fields, bulk marshalling against one call per field
+    runner.setup(
+        "$v4 = [1.5, 2.5, 3.5, 4.5]\n"
+        "$h4 = { x: 1.5, y: 2.5, z: 3.5, w: 4.5 }\n"
+    );
+    runner.add("attr", "get", "o.x", "r.x");
+    runner.add("attr", "set", "o.x = 1.5", "r.x = 1.5");
+    runner.add("attr", "to_a", "o.to_a", "[r.x, r.y, r.z, r.w]");
+    runner.add("attr", "to_h", "o.to_h", "{ x: r.x, y: r.y, z: r.z, w: r.w }");
+    runner.add("attr", "from_a", "o.from_a $v4", "v = $v4; r.x = v[0]; r.y = v[1]; r.z = v[2]; r.w = v[3]");
+    runner.add("attr", "from_h", "o.from_h $h4", "h = $h4; r.x = h[:x]; r.y = h[:y]; r.z = h[:z]; r.w = h[:w]");
+    // every ruby_arg
+    static const char* const types[][2] = {
+        { "int32",      "1" },
+        { "uint32",     "1" },
+        { "float",      "1.5" },
+        { "double",     "1.5" },
+        { "bool",       "true" },
+        { "string",     "'binder'" },
+        { "pointer",    "p" },
+        { "bytes",      "'binder'" },
+        { "static",     "1" },
+        { "original",   "1" },
+        { "self",       "" },
+    };
+    for (const auto& t : types) {
+        const auto call = std::string(".t_") + t[0] + " " + t[1];
+        runner.add("type", t[0], "o" + call, "r" + call);
+    }
+    // overload set, monomorphic and polymorphic call site
+    runner.add("overload", "int", "o.over 1", "r.over 1");
+    runner.add("overload", "string", "o.over 'binder'", "r.over 'binder'");
+    runner.add("overload", "mixed", "o.over(1); o.over('binder'); o.over(1, 2)", "r.over(1); r.over('binder'); r.over(1, 2)");
+    // c++ calling ruby, cached handle against mrb_funcall by name and mrb_yield, 100 callbacks per call
+    runner.setup(
+        "class Handler\n  def cb(x)\n    x\n  end\nend\n"
+        "$handler = Handler.new\n"
+        "$blk = Proc.new { |x| x }\n"
+    );
+    {
+        auto handler = BindER::ruby_binder(mruby).method<int32_t(int32_t)>(
+            ::mrb_gv_get(mruby, mrb_intern_lit(mruby, "$handler")), "cb"
+        );
+        g_handler = &handler;
+        runner.add("callback", "method", "o.t_send 100", "r.t_send 100", loop / 100);
+        runner.add("callback", "proc", "o.t_yield 100, $blk", "r.t_yield 100, $blk", loop / 100);
+        g_handler = nullptr;
+    }
+    // value class stored inline against heap class, raw column is the heap one
+    runner.setup(
+        "$va = Vec.new(1.0, 2.0, 3.0)\n$vb = Vec.new(0.5, 0.5, 0.5)\n"
+        "$ha = HeapVec.new(1.0, 2.0, 3.0)\n$hb = HeapVec.new(0.5, 0.5, 0.5)\n"
+    );
+    runner.add("value", "new", "Vec.new 1.0, 2.0, 3.0", "HeapVec.new 1.0, 2.0, 3.0");
+    runner.add("value", "add", "$va.add $vb", "$ha.add $hb");
+    runner.add("value", "attr", "$va.x", "$ha.x");
+    // 256KB native buffer per object, size reported against not, peak of live buffers to stderr
+    runner.add("gc", "blob", "SizedBlob.new", "Blob.new", 4000);
+    std::fprintf(stderr, "gc: peak live blobs %zu sized, %zu unsized\n", 
+        BenchBlob<true>::peak.load(), BenchBlob<false>::peak.load()
+    );
+    // 64 calls suspending fibers, run by async_loop with 64 threads, against 64 blocking calls
+    {
+        BindER::async_loop aloop(mruby, 64);
+        const auto path = get_cache_dir() + "/binder_bench_read.bin";
+        std::ofstream(path, std::ios::binary) << std::string(64 << 10, 'x');
+        ::mrb_gv_set(mruby, mrb_intern_lit(mruby, "$path"), ::mrb_str_new_cstr(mruby, path.c_str()));
+        const auto fibers = [](const char* call) {
+            return std::string("Array.new(64) { Fiber.new { Bench.") + call + " } }.each { |f| f.resume }";
+        };
+        const auto blocking = [](const char* call) { return std::string("64.times { Bench.") + call + " }"; };
+        runner.add("async", "sleep", run_async(mruby, aloop, fibers("a_sleep 1"), 20), 
+            run_async(mruby, aloop, blocking("s_sleep 1"), 20));
+        runner.add("async", "read", run_async(mruby, aloop, fibers("a_read $path"), 100), 
+            run_async(mruby, aloop, blocking("s_read $path"), 100));
+        std::remove(path.c_str());
+    }
+    // startup against compiling source: cold = compile and store, warm = mapped bytecode
+    {
+        const auto script = make_startup_script();
+        const auto source = run_startup(script, nullptr, 20);
+        BindER::script_cache cache(get_cache_dir());
+        // file of the same bindings as run_startup
+        const auto mrb = ::mrb_open();
+        binder_bench(mrb);
+        cache.remove(mrb, script.c_str(), script.size());
+        runner.add("startup", "cold", run_startup(script, &cache, 1), source);
+        runner.add("startup", "warm", run_startup(script, &cache, 20), source);
+        cache.remove(mrb, script.c_str(), script.size());
+        ::mrb_close(mrb);
+    }
+    // open state with 5k methods: bind() per method, eager table and lazy table against mrb_define_method
+    {
+        const auto raw = run_init(wide_mode::raw, 20);
+        runner.add("init", "bind", run_init(wide_mode::bind, 20), raw);
+        runner.add("init", "table", run_init(wide_mode::table, 20), raw);
+        runner.add("init", "lazy", run_init(wide_mode::lazy, 20), raw);
+    }
+    // worker pool throughput against one thread, 100k calls per job
+    const auto single = run_workers(1, 64);
+    const auto hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t n = 2; n <= hardware; n *= 2) {
+        runner.add("workers", "threads" + std::to_string(n), run_workers(n, 64), single);
+    }
+#ifdef BINDER_RUBY_PROFILE
+    // per-binding counters to stderr, keep stdout for results
+    std::fputs(BindER::ruby_binder(mruby).dump_profile(json).c_str(), stderr);
+#endif
+    ::mrb_close(mruby);
+    if (json) print_json(runner.get_results(), args_mode, loop);
+    else print_text(runner.get_results());
+    return 0;
+}
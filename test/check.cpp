@@ -0,0 +1,633 @@
+// checks of BindER against mruby, exit code is count of failures
+#define BINDER_RUBY_SCRIPT_CACHE
+#define BINDER_RUBY_PROFILE
+#define BINDER_RUBY_ASYNC
+#include "../bindenvruby.h"
+#include <mruby/compile.h>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+// count of failures
+static std::atomic<int> g_failures{ 0 };
+
+// check ruby expression is truthy
+static void check(mrb_state* mrb, const char* expr) {
+    const auto value = ::mrb_load_string(mrb, expr);
+    if (mrb->exc) {
+        std::fprintf(stderr, "raised %s: %s\n", ::mrb_obj_classname(mrb, ::mrb_obj_value(mrb->exc)), expr);
+        mrb->exc = nullptr;
+        ++g_failures;
+    }
+    else if (!mrb_test(value)) {
+        std::fprintf(stderr, "failed: %s\n", expr);
+        ++g_failures;
+    }
+}
+
+// check ruby expression raises 'error'
+static void check_raise(mrb_state* mrb, const char* expr, const char* error) {
+    ::mrb_load_string(mrb, expr);
+    const auto name = mrb->exc ? ::mrb_obj_classname(mrb, ::mrb_obj_value(mrb->exc)) : "nothing";
+    if (std::strcmp(name, error)) {
+        std::fprintf(stderr, "raised %s, expected %s: %s\n", name, error, expr);
+        ++g_failures;
+    }
+    mrb->exc = nullptr;
+}
+
+// class for class-methods
+struct Checks { };
+
+// classes told apart in overload set
+struct CheckA { };
+struct CheckB { };
+
+// overload set: first match wins, cache never changes the selection
+static void check_overload(mrb_state* mrb) {
+    auto binder = BindER::ruby_binder(mrb);
+    auto cbinder = binder.bind_class("Checks", []() noexcept { return new(std::nothrow) Checks; });
+    cbinder.bind_overload("pick", 
+        [](int32_t) noexcept { return 0; }, 
+        [](bool) noexcept { return 1; }
+    );
+    cbinder.bind_overload("num", 
+        [](int32_t) noexcept { return 0; }, 
+        [](float) noexcept { return 1; }
+    );
+    cbinder.bind_overload("wide", 
+        [](double) noexcept { return 0; }, 
+        [](int32_t) noexcept { return 1; }
+    );
+    check(mrb, "Checks.pick(1) == 0 && Checks.pick(true) == 1 && Checks.pick(false) == 1");
+    check(mrb, "[true, 1, false, 2].map { |x| Checks.pick(x) } == [1, 0, 1, 0]");
+    check(mrb, "Checks.num(1) == 0 && Checks.num(1.5) == 1");
+    check(mrb, "[1, 1.5, 2, 2.5].map { |x| Checks.num(x) } == [0, 1, 0, 1]");
+    check(mrb, "[1, 1.5].map { |x| Checks.wide(x) } == [0, 0]");
+    check_raise(mrb, "Checks.pick('a')", "ArgumentError");
+    check_raise(mrb, "Checks.num(nil)", "ArgumentError");
+    // same masks, told apart by class of object and type of elements
+    binder.bind_class("CheckA", []() noexcept { return new(std::nothrow) CheckA; });
+    binder.bind_class("CheckB", []() noexcept { return new(std::nothrow) CheckB; });
+    cbinder.bind_overload("obj", 
+        [](CheckA*) noexcept { return 0; }, 
+        [](CheckB*) noexcept { return 1; }
+    );
+    cbinder.bind_overload("elems", 
+        [](const std::vector<int32_t>&) noexcept { return 0; }, 
+        [](const std::vector<float>&) noexcept { return 1; }
+    );
+    cbinder.bind_overload("strs", 
+        [](const std::vector<std::string>& v) noexcept { return int32_t(v.size()); }, 
+        [](int32_t) noexcept { return -1; }
+    );
+    check(mrb, "Checks.obj(CheckA.new) == 0 && Checks.obj(CheckB.new) == 1");
+    check(mrb, "[CheckB.new, CheckA.new].map { |x| Checks.obj(x) } == [1, 0]");
+    check(mrb, "Checks.elems([1, 2]) == 0 && Checks.elems([1.5, 2]) == 1 && Checks.elems([]) == 0");
+    check(mrb, "[[1], [1.5], [2]].map { |x| Checks.elems(x) } == [0, 1, 0]");
+    check(mrb, "Checks.strs(['a', 'b']) == 2 && Checks.strs(1) == -1");
+    check_raise(mrb, "Checks.strs([1])", "ArgumentError");
+    check_raise(mrb, "Checks.obj(Checks.new)", "ArgumentError");
+}
+
+// node for identity checks, deletes counted
+struct Node { 
+    ~Node() { ++deleted; }
+    Node* parent = nullptr;
+    static int deleted;
+};
+int Node::deleted = 0;
+
+// class of another type
+struct Other { };
+
+// identity map: same wrapper reused, borrowed never deleted, wrong class raises
+static void check_identity(mrb_state* mrb) {
+    static Node root;
+    auto binder = BindER::ruby_binder(mrb);
+    auto nbinder = binder.bind_class("Node", []() noexcept { return new(std::nothrow) Node; });
+    binder.bind_class("Other", []() noexcept { return new(std::nothrow) Other; });
+    nbinder.bind_attr("parent", &Node::parent);
+    nbinder.bind("me", [](Node* obj) noexcept { return obj; });
+    nbinder.bind("adopt", [](Node* obj, Node& child) noexcept { child.parent = obj; });
+    nbinder.bind("clone", [](const Node* obj) noexcept { return BindER::owned<Node>(new Node(*obj)); });
+    nbinder.bind("root", []() noexcept { return &root; });
+    nbinder.bind("deleted", []() noexcept { return int32_t(Node::deleted); });
+    check(mrb, "a = Node.new; b = Node.new; b.parent = a; b.parent.equal?(a)");
+    check(mrb, "a = Node.new; b = Node.new; a.adopt(b); b.parent.equal?(a)");
+    check(mrb, "a = Node.new; a.me.equal?(a) && a.me.me.equal?(a)");
+    check(mrb, "Node.root.equal?(Node.root) && Node.root.parent.nil?");
+    // borrowed wrapper collected, object kept; owned one deleted by gc
+    check(mrb, "$deleted = Node.deleted; 10.times { Node.root; Node.root.clone }; true");
+    check(mrb, "GC.start; Node.deleted > $deleted && Node.root.me.equal?(Node.root)");
+    check(mrb, "$deleted = Node.deleted; 10.times { Node.root }; GC.start; Node.deleted == $deleted");
+    check_raise(mrb, "Node.new.parent = Other.new", "TypeError");
+    check_raise(mrb, "Node.new.adopt(Other.new)", "TypeError");
+    check_raise(mrb, "Node.new.adopt(nil)", "TypeError");
+    check(mrb, "a = Node.new; a.parent = Node.root; a.parent = nil; a.parent.nil?");
+}
+
+// ruby method called from c++: super sees the method's own frame
+static void check_method(mrb_state* mrb) {
+    auto binder = BindER::ruby_binder(mrb);
+    const auto recv = ::mrb_load_string(mrb, 
+        "class Base; def greet(x) x * 2 end end\n"
+        "class Derived < Base; def greet(x) super + 1 end; def plain(x) x + 1 end end\n"
+        "Derived.new");
+    auto greet = binder.method<int32_t(int32_t)>(recv, "greet");
+    auto plain = binder.method<int32_t(int32_t)>(recv, "plain");
+    if (greet(3) != 7 || greet(4) != 9 || plain(3) != 4 || mrb->exc) {
+        std::fprintf(stderr, "failed: ruby method with super\n");
+        mrb->exc = nullptr;
+        ++g_failures;
+    }
+    check(mrb, "Derived.new.greet(3) == 7");
+}
+
+// class of lazy table
+struct Lazy { };
+// lazy methods
+static int32_t lazy_value(const Lazy*) noexcept { return 1; }
+static const char* lazy_to_s(const Lazy*) noexcept { return "lazy"; }
+static int32_t lazy_count() noexcept { return 2; }
+// lazy cfunc taking a block: a * b yielded if given, a + b otherwise
+static mrb_value lazy_pair(mrb_state* mrb, mrb_value) noexcept {
+    mrb_int a, b; mrb_value block;
+    ::mrb_get_args(mrb, "ii&", &a, &b, &block);
+    return mrb_nil_p(block) ? ::mrb_fixnum_value(a + b) : ::mrb_yield(mrb, block, ::mrb_fixnum_value(a * b));
+}
+// lazy table, to_s exists on Object
+static constexpr BindER::method_entry lazy_table[] = {
+    BindER::table_method<Lazy, decltype(&lazy_value), &lazy_value>("value"),
+    BindER::table_method<Lazy, decltype(&lazy_to_s), &lazy_to_s>("to_s"),
+    BindER::table_method<Lazy, decltype(&lazy_count), &lazy_count>("count"),
+    { "pair", &lazy_pair, false },
+};
+
+// lazy table: names of ancestors defined at once, previous method_missing kept
+static void check_lazy_table(mrb_state* mrb) {
+    auto binder = BindER::ruby_binder(mrb);
+    auto lbinder = binder.bind_class("Lazy", []() noexcept { return new(std::nothrow) Lazy; });
+    ::mrb_load_string(mrb, 
+        "class Lazy; def method_missing(name, *args) name == :dynamic ? args.size : super end; "
+        "def respond_to_missing?(name, priv = false) name == :dynamic || super end end");
+    lbinder.bind_table(lazy_table, true);
+    check(mrb, "Lazy.new.to_s == 'lazy'");
+    check(mrb, "Lazy.new.value == 1 && Lazy.count == 2");
+    // first call through method_missing passes arguments and block on
+    check(mrb, "Lazy.new.pair(3, 4) { |x| x + 1 } == 13 && Lazy.new.pair(3, 4) == 7");
+    check(mrb, "Lazy.new.respond_to?(:value) && Lazy.new.respond_to?(:dynamic) && !Lazy.new.respond_to?(:other)");
+    check(mrb, "Lazy.new.dynamic(1, 2) == 2");
+    check_raise(mrb, "Lazy.new.other", "NoMethodError");
+    check_raise(mrb, "Lazy.other", "NoMethodError");
+}
+
+// class of lazy sequences
+struct Seqs { };
+// rows borrowed by sequence
+static std::vector<int32_t> seq_rows = { 1, 2, 3 };
+
+// lazy sequence: cursor per each call, lvalue range borrowed, generator single pass
+static void check_sequence(mrb_state* mrb) {
+    auto binder = BindER::ruby_binder(mrb);
+    auto sbinder = binder.bind_class("Seqs", []() noexcept { return new(std::nothrow) Seqs; });
+    sbinder.bind("rows", []() noexcept { return BindER::lazy(seq_rows); });
+    sbinder.bind("moved", []() noexcept { return BindER::lazy(std::vector<int32_t>{ 4, 5 }); });
+    sbinder.bind("count", [](int32_t n) noexcept { 
+        return BindER::generator<int32_t>([i = 0, n](int32_t& v) mutable noexcept { return i < n ? (v = i++, true) : false; });
+    });
+    check(mrb, "s = Seqs.rows; s.to_a == [1, 2, 3] && s.to_a == [1, 2, 3]");
+    check(mrb, "s = Seqs.rows; s.map { |x| s.to_a } == [[1, 2, 3]] * 3");
+    check(mrb, "s = Seqs.rows; r = []; s.each { |x| s.each { |y| break }; r << x }; r == [1, 2, 3]");
+    check(mrb, "Seqs.moved.to_a == [4, 5]");
+    check(mrb, "g = Seqs.count(4); g.each { |x| break if x == 1 }; g.to_a == [2, 3] && g.to_a == []");
+    check(mrb, "$rows = Seqs.rows; true");
+    seq_rows[0] = 9;
+    check(mrb, "$rows.to_a == [9, 2, 3]");
+    seq_rows[0] = 1;
+}
+
+// class for closures
+struct Closures { };
+
+// same closure type bound twice, every method calls its own copy
+static void check_closure(mrb_state* mrb) {
+    auto binder = BindER::ruby_binder(mrb);
+    auto cbinder = binder.bind_class("Closures", []() noexcept { return new(std::nothrow) Closures; });
+    const auto make = [](int32_t k) { return [k](int32_t x) noexcept { return k * 10 + x; }; };
+    cbinder.bind("first", make(1));
+    cbinder.bind("second", make(2));
+    check(mrb, "Closures.first(3) == 13 && Closures.second(3) == 23 && Closures.first(4) == 14");
+}
+
+// pooled object, constructions and destructions counted
+struct Pooled {
+    Pooled(int32_t v) noexcept : value(v) { ++made; }
+    ~Pooled() { ++freed; }
+    int32_t value;
+    static int made, freed;
+};
+int Pooled::made = 0;
+int Pooled::freed = 0;
+
+// slab pool: objects in place, slots reused after gc, every object destructed at close
+static void check_pool() {
+    const auto mrb = ::mrb_open();
+    auto binder = BindER::ruby_binder(mrb);
+    auto pbinder = binder.bind_class("Pooled", [](BindER::pool_slot<Pooled> slot, int32_t v) noexcept { return slot.construct(v); });
+    pbinder.bind("value", [](const Pooled* obj) noexcept { return obj->value; });
+    check(mrb, "a = Pooled.new(7); a.value == 7");
+    check(mrb, "100.times { |i| Pooled.new(i) }; GC.start; $kept = (0...10).map { |i| Pooled.new(i) }; true");
+    const auto stats = pbinder.get_pool_stats();
+    if (stats.live < 10 || stats.high_water < stats.live || !stats.bytes) {
+        std::fprintf(stderr, "pool: %zu live, %zu high water, %zu bytes\n", stats.live, stats.high_water, stats.bytes);
+        ++g_failures;
+    }
+    check(mrb, "$kept.map(&:value) == (0...10).to_a");
+    ::mrb_close(mrb);
+    if (Pooled::made != Pooled::freed) {
+        std::fprintf(stderr, "pool: %d made, %d freed after close\n", Pooled::made, Pooled::freed);
+        ++g_failures;
+    }
+}
+
+// class for strings
+struct Strings { };
+
+// zero-copy strings: length kept, embedded NUL round-trips
+static void check_strings(mrb_state* mrb) {
+    using namespace BindER::literals;
+    auto binder = BindER::ruby_binder(mrb);
+    auto sbinder = binder.bind_class("Strings", []() noexcept { return new(std::nothrow) Strings; });
+    sbinder.bind("span", [](BindER::span<const char> s) noexcept { return s; });
+    sbinder.bind("bytes", [](BindER::span<const uint8_t> s) noexcept { return s; });
+    sbinder.bind("size", [](BindER::span<const char> s) noexcept { return int32_t(s.size); });
+    sbinder.bind("copy", [](const std::string& s) { return s; });
+    sbinder.bind("name", []() noexcept { return "a\0b"_static; });
+    check(mrb, "Strings.span(\"a\\0b\") == \"a\\0b\" && Strings.size(\"a\\0b\") == 3");
+    check(mrb, "Strings.bytes(\"a\\0b\") == \"a\\0b\" && Strings.copy(\"a\\0b\") == \"a\\0b\"");
+    check(mrb, "Strings.name == \"a\\0b\" && Strings.name.size == 3 && Strings.span('') == ''");
+#if __cplusplus >= 201703L
+    sbinder.bind("view", [](std::string_view s) noexcept { return s; });
+    sbinder.bind("view_size", [](std::string_view s) noexcept { return int32_t(s.size()); });
+    check(mrb, "Strings.view(\"a\\0b\") == \"a\\0b\" && Strings.view_size(\"a\\0b\") == 3 && Strings.view('') == ''");
+#endif
+    check_raise(mrb, "Strings.span(1)", "TypeError");
+}
+
+// class for arrays
+struct Arrays { };
+
+// arrays: round-trip, mixed int/float, element type, empty, 64-bit boxing
+static void check_arrays(mrb_state* mrb) {
+    auto binder = BindER::ruby_binder(mrb);
+    auto abinder = binder.bind_class("Arrays", []() noexcept { return new(std::nothrow) Arrays; });
+    abinder.bind("ints", [](const std::vector<int32_t>& v) { return v; });
+    abinder.bind("floats", [](std::vector<float> v) { return v; });
+    abinder.bind("doubles", [](BindER::span<const double> s) noexcept { return s; });
+    abinder.bind("sum", [](BindER::span<const int32_t> s) noexcept { 
+        int32_t r = 0; for (size_t i = 0; i != s.size; ++i) r += s.data[i]; return r; 
+    });
+    abinder.bind("wide", []() { return std::vector<int64_t>{ 1, int64_t(1) << 40 }; });
+    check(mrb, "Arrays.ints([1, 2, 3]) == [1, 2, 3] && Arrays.floats([0.5, 1.5]) == [0.5, 1.5]");
+    check(mrb, "Arrays.doubles([1, 2.5]) == [1.0, 2.5] && Arrays.ints([1, 2.0]) == [1, 2]");
+    check(mrb, "Arrays.ints([]) == [] && Arrays.doubles([]) == [] && Arrays.sum([]) == 0");
+    // larger than inline buffer of span
+    check(mrb, "Arrays.sum((1..1000).to_a) == 500500");
+    check(mrb, "Arrays.wide[0] == 1 && Arrays.wide[1] == 1099511627776");
+    check_raise(mrb, "Arrays.ints([1, 'a'])", "TypeError");
+    check_raise(mrb, "Arrays.doubles([1.5, nil])", "TypeError");
+}
+
+
+#ifdef BINDER_RUBY_PROFILE
+// class for profile
+struct Profiled { };
+
+// state raising from a bound body
+static mrb_state* g_profiled = nullptr;
+
+// profile: returned calls counted, raised ones not, reset clears
+static void check_profile(mrb_state* mrb) {
+    auto binder = BindER::ruby_binder(mrb);
+    auto pbinder = binder.bind_class("Profiled", []() noexcept { return new(std::nothrow) Profiled; });
+    pbinder.bind("twice", [](int32_t x) noexcept { return x * 2; });
+    pbinder.bind("fail", []() noexcept { ::mrb_raise(g_profiled, ::mrb_class_get(g_profiled, "RuntimeError"), "fail"); });
+    g_profiled = mrb;
+    binder.reset_profile();
+    check(mrb, "Profiled.twice(1) == 2 && Profiled.twice(2) == 4");
+    check_raise(mrb, "Profiled.twice('a')", "TypeError");
+    check_raise(mrb, "Profiled.fail", "RuntimeError");
+    uint64_t twice = ~uint64_t(0), fail = ~uint64_t(0);
+    for (const auto& r : binder.get_profile()) {
+        if (r.class_name != "Profiled" || !r.singleton) continue;
+        if (r.method_name == "twice") twice = r.calls;
+        if (r.method_name == "fail") fail = r.calls;
+    }
+    if (twice != 2 || fail != 0) {
+        std::fprintf(stderr, "failed: profile calls twice=%llu fail=%llu\n", 
+            (unsigned long long)twice, (unsigned long long)fail);
+        ++g_failures;
+    }
+    if (binder.dump_profile().find("twice") == std::string::npos) {
+        std::fprintf(stderr, "failed: profile dump\n");
+        ++g_failures;
+    }
+    binder.reset_profile();
+    for (const auto& r : binder.get_profile()) {
+        if (r.calls) { std::fprintf(stderr, "failed: profile reset\n"); ++g_failures; break; }
+    }
+}
+#endif
+
+
+// class for batch calls
+struct Batch { int32_t value = 0; };
+
+// batch: name_each over receivers and tuples, collected or discarded
+static void check_batch(mrb_state* mrb) {
+    auto binder = BindER::ruby_binder(mrb);
+    auto bbinder = binder.bind_class("Batch", []() noexcept { return new(std::nothrow) Batch; });
+    bbinder.bind_attr("value", &Batch::value);
+    bbinder.bind_batch("add", [](Batch* b, int32_t x) noexcept { return b->value += x; });
+    bbinder.bind_batch("bump", [](Batch* b) noexcept { ++b->value; }, BindER::batch_mode::discard);
+    bbinder.bind_batch("square", [](int32_t x) noexcept { return x * x; });
+    bbinder.bind_batch("mul", [](int32_t a, int32_t b) noexcept { return a * b; });
+    check(mrb, "$bs = [Batch.new, Batch.new, Batch.new]; Batch.add_each($bs, 2) == [2, 2, 2]");
+    check(mrb, "Batch.add_each($bs, 3) == [5, 5, 5] && $bs[0].add(1) == 6");
+    check(mrb, "Batch.bump_each($bs).equal?($bs) && $bs.map { |b| b.value } == [7, 6, 6]");
+    check(mrb, "Batch.square_each([1, 2, 3]) == [1, 4, 9] && Batch.mul_each([[2, 3], [4, 5]]) == [6, 20]");
+    check(mrb, "Batch.add_each([], 1) == [] && Batch.square_each([]) == []");
+    check_raise(mrb, "Batch.add_each([Batch.new, 1], 1)", "TypeError");
+    check_raise(mrb, "Batch.square_each([1, 'a'])", "TypeError");
+}
+
+
+// class bound in several states
+struct Twin { 
+    explicit Twin(int32_t v) noexcept : value(v) {}
+    int32_t value;
+};
+
+// bind and use Twin in one state
+static void check_twin(mrb_state* mrb) {
+    auto binder = BindER::ruby_binder(mrb);
+    auto tbinder = binder.bind_class("Twin", [](int32_t v) noexcept { return new(std::nothrow) Twin(v); });
+    tbinder.bind("value", [](const Twin* t) noexcept { return t->value; });
+    tbinder.bind("same", [](Twin* t) noexcept { return t; });
+    check(mrb, "t = Twin.new(3); t.value == 3 && t.same.equal?(t)");
+    check(mrb, "(0...1000).map { |i| Twin.new(i) }.map { |t| t.value }.inject(:+) == 499500");
+}
+
+// same type in two states side by side and in one state per thread
+static void check_states() {
+    const auto a = ::mrb_open();
+    const auto b = ::mrb_open();
+    check_twin(a);
+    check_twin(b);
+    check(a, "$a = Twin.new(1); true");
+    check(b, "$b = Twin.new(2); true");
+    ::mrb_close(a);
+    check(b, "GC.start; $b.value == 2 && Twin.new(5).same.value == 5");
+    ::mrb_close(b);
+    std::thread threads[4];
+    for (auto& t : threads) t = std::thread([]() {
+        const auto mrb = ::mrb_open();
+        check_twin(mrb);
+        ::mrb_close(mrb);
+    });
+    for (auto& t : threads) t.join();
+}
+
+
+// class for fields
+struct Point { 
+    float x = 0; 
+    int32_t y = 0; 
+    std::string name; 
+    const int32_t id = 7; 
+};
+
+// fields: to_h/from_h and to_a/from_a round-trip, const field kept, wrong type raises
+static void check_fields(mrb_state* mrb) {
+    auto binder = BindER::ruby_binder(mrb);
+    auto pbinder = binder.bind_class("Point", []() noexcept { return new(std::nothrow) Point; });
+    pbinder.bind_attr("x", &Point::x);
+    pbinder.bind_attr("y", &Point::y);
+    pbinder.bind_attr("name", &Point::name);
+    pbinder.bind_attr("id", &Point::id);
+    check(mrb, "$p = Point.new; $p.x = 1.5; $p.y = 2; $p.name = 'n'; $p.to_h == { x: 1.5, y: 2, name: 'n', id: 7 }");
+    check(mrb, "q = Point.new; q.from_h($p.to_h).equal?(q) && q.to_h == $p.to_h");
+    check(mrb, "q = Point.new.from_h(x: 0.5, id: 9); q.to_h == { x: 0.5, y: 0, name: '', id: 7 }");
+    check(mrb, "$p.from_h(y: 5).to_a == [1.5, 5, 'n', 7] && Point.new.from_a($p.to_a).to_a == $p.to_a");
+    check(mrb, "Point.new.from_a([2.5]).to_a == [2.5, 0, '', 7] && Point.new.from_h({}).to_h[:y] == 0");
+    check_raise(mrb, "Point.new.from_h(x: 'a')", "TypeError");
+    check_raise(mrb, "Point.new.from_h(1)", "TypeError");
+    check_raise(mrb, "Point.new.from_a([1.0, 'b'])", "TypeError");
+}
+
+
+// object holding a ruby value
+struct Holder { mrb_value kept = ::mrb_nil_value(); };
+
+// state of Holder calls
+static mrb_state* g_holder = nullptr;
+
+// gc mark: value stored by c++ kept across GC.start once snapshot by mark_objects
+static void check_gc_mark(mrb_state* mrb) {
+    g_holder = mrb;
+    auto binder = BindER::ruby_binder(mrb);
+    auto hbinder = binder.bind_class("Holder", []() noexcept { return new(std::nothrow) Holder; });
+    hbinder.set_gc_mark([](const Holder* h, BindER::gc_marker& m) noexcept { m.mark(h->kept); });
+    hbinder.bind("keep", [](Holder* h, BindER::ruby_proc<int32_t()> p) noexcept { h->kept = p.get_value(); });
+    hbinder.bind("run", [](Holder* h) noexcept { return BindER::ruby_proc<int32_t()>(g_holder, h->kept)(); });
+    check(mrb, "$h = Holder.new; $h.keep(proc { 40 + 2 }); true");
+    binder.mark_objects();
+    check(mrb, "GC.start; Array.new(1000) { |i| 'x' * i }; GC.start; $h.run == 42");
+    // replaced value kept, old one dropped at the next snapshot
+    check(mrb, "$h.keep(proc { 7 }); true");
+    binder.mark_objects();
+    check(mrb, "GC.start; Array.new(1000) { |i| 'y' * i }; GC.start; $h.run == 7");
+}
+
+
+// value class stored inline
+struct Vec2 { float x, y; };
+// class by value stored on heap
+struct Box { int32_t value; };
+// class without value_class trait
+struct NoValue { int32_t value; };
+namespace BindER {
+    template<> struct value_class<Vec2> : std::true_type {};
+    template<> struct value_class<Box> : std::true_type {};
+}
+
+// argument by value is available for value classes only
+template<typename T, typename = void> struct has_value_arg : std::false_type {};
+template<typename T> struct has_value_arg<T, decltype(void(
+    BindER::ruby_arg<T>::get(std::declval<mrb_state*>(), std::declval<const mrb_value&>())))> : std::true_type {};
+static_assert(has_value_arg<Vec2>::value && has_value_arg<Box>::value, "value class by value");
+static_assert(!has_value_arg<NoValue>::value, "class without value_class trait is rejected");
+
+// value classes: copies by value, in place by const T&, heap copy for bind_class
+static void check_values(mrb_state* mrb) {
+    auto binder = BindER::ruby_binder(mrb);
+    auto vbinder = binder.bind_value("Vec2", [](float x, float y) noexcept { return Vec2{ x, y }; });
+    vbinder.bind_attr("x", &Vec2::x);
+    vbinder.bind_attr("y", &Vec2::y);
+    vbinder.bind("same", [](const Vec2* a, const Vec2& b) noexcept { return a == &b; });
+    vbinder.bind("poke", [](const Vec2*, Vec2 v) noexcept { v.x = 100; return v.x; });
+    vbinder.bind("copy", [](const Vec2* a) noexcept { return *a; });
+    vbinder.bind("+", [](const Vec2* a, const Vec2& b) noexcept { return Vec2{ a->x + b.x, a->y + b.y }; });
+    auto bbinder = binder.bind_class("Box", [](int32_t v) noexcept { return new(std::nothrow) Box{ v }; });
+    bbinder.bind_attr("value", &Box::value);
+    bbinder.bind("copy", [](const Box* b) noexcept { return *b; });
+    bbinder.bind("take", [](const Box*, Box b) noexcept { b.value = -1; return b.value; });
+    check(mrb, "v = Vec2.new(1, 2); v.same(v) && !v.same(Vec2.new(1, 2))");
+    check(mrb, "v = Vec2.new(1, 2); v.poke(v) == 100 && v.x == 1");
+    check(mrb, "v = Vec2.new(1, 2); c = v.copy; c.x = 5; v.x == 1 && c.x == 5 && !c.equal?(v)");
+    check(mrb, "v = Vec2.new(1, 2) + Vec2.new(3, 4); v.x == 4 && v.y == 6");
+    check(mrb, "b = Box.new(3); c = b.copy; c.value = 4; b.value == 3 && c.value == 4 && b.take(c) == -1 && c.value == 4");
+    check_raise(mrb, "Vec2.new(1, 2).same(Box.new(1))", "TypeError");
+    check_raise(mrb, "Box.new(1).take(Vec2.new(1, 2))", "TypeError");
+}
+
+
+#ifdef BINDER_RUBY_ASYNC
+// class for async calls
+struct Asyncs { };
+
+// completions kept to be called after the script returned
+static std::vector<BindER::completion<int32_t>> g_later;
+
+// async: pool form with borrowed strings, completion form, root fiber blocking
+static void check_async(mrb_state* mrb) {
+    BindER::async_loop loop(mrb, 2);
+    auto binder = BindER::ruby_binder(mrb);
+    auto abinder = binder.bind_class("Asyncs", []() noexcept { return new(std::nothrow) Asyncs; });
+    abinder.bind_async("size", [](const char* s) noexcept { 
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        return int32_t(std::strlen(s)); 
+    });
+    abinder.bind_async("copy", [](BindER::span<const char> s) { 
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        return std::string(s.data, s.size); 
+    });
+    abinder.bind_async("later", [](int32_t x, BindER::completion<int32_t> done) { 
+        (void)x; g_later.push_back(done); 
+    });
+    abinder.bind_async("now", [](int32_t x, BindER::completion<int32_t> done) { done(x + 1); });
+#if __cplusplus >= 201703L
+    abinder.bind_async("view", [](std::string_view s) { 
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        return std::string(s); 
+    });
+    check(mrb, "$s = 'def' * 100; $v = nil; Fiber.new { $v = Asyncs.view($s) }.resume; $s.replace('z' * 1000); true");
+    loop.run();
+    check(mrb, "$v == 'def' * 100");
+#endif
+    // ruby strings changed while the pool jobs run
+    check(mrb, "$r = []; $s = 'abc' * 100; "
+        "Fiber.new { $r << Asyncs.size($s) }.resume; Fiber.new { $r << Asyncs.copy($s) }.resume; "
+        "$s.replace('x'); $s << 'y' * 1000; true");
+    if (loop.run() != 2) { std::fprintf(stderr, "failed: async pool resumed\n"); ++g_failures; }
+    check(mrb, "$r.size == 2 && $r.include?(300) && $r.include?('abc' * 100)");
+    // completion called from c++, fibers resumed by poll
+    g_later.clear();
+    check(mrb, "$r = []; [1, 2].each { |i| Fiber.new { $r << Asyncs.later(i) }.resume }; $r.empty?");
+    for (size_t i = 0; i != g_later.size(); ++i) g_later[i](int32_t(i + 1) * 10);
+    size_t resumed = 0;
+    while (loop.get_pending()) resumed += loop.poll(true);
+    if (resumed != 2 || loop.get_errors()) { std::fprintf(stderr, "failed: async poll resumed\n"); ++g_failures; }
+    check(mrb, "$r == [10, 20]");
+    // root fiber blocks until done
+    check(mrb, "Asyncs.size('abcd') == 4 && Asyncs.copy('ab') == 'ab' && Asyncs.now(1) == 2");
+}
+#endif
+
+
+// script for cache, methods/literals/symbols used after load returned
+static const char* const cached_script = 
+    "def cached_a\n  'literal a'\nend\n"
+    "def cached_b(x)\n  x.to_s + 'literal b'\nend\n"
+    "$cached = :cached_symbol\n"
+    "cached_a\n";
+
+// script cache: cold load stores, warm load maps, mapping alive after load returned
+static void check_script_cache() {
+    const auto tmp = std::getenv("TMPDIR");
+    BindER::script_cache cache(tmp ? tmp : "/tmp");
+    const auto len = std::strlen(cached_script);
+    const auto clean = ::mrb_open();
+    cache.remove(clean, cached_script, len);
+    for (int i = 0; i != 2; ++i) {
+        const auto mrb = ::mrb_open();
+        cache.load(mrb, cached_script, len);
+        // heap churn and collection between load and use
+        check(mrb, "Array.new(1000) { |i| 'x' * i }; GC.start; true");
+        check(mrb, "cached_a == 'literal a'");
+        check(mrb, "cached_b(1) == '1literal b'");
+        check(mrb, "$cached == :cached_symbol && $cached.to_s == 'cached_symbol'");
+        check(mrb, "Object.respond_to?(:cached_b, true)");
+        ::mrb_close(mrb);
+    }
+    if (cache.get_misses() != 1 || cache.get_hits() != 1) {
+        std::fprintf(stderr, "script cache: %zu hits, %zu misses\n", cache.get_hits(), cache.get_misses());
+        ++g_failures;
+    }
+    // bindings differ: own file, compiled again
+    check_twin(clean);
+    cache.remove(clean, cached_script, len);
+    cache.load(clean, cached_script, len);
+    check(clean, "cached_a == 'literal a'");
+    if (cache.get_misses() != 2) {
+        std::fprintf(stderr, "script cache: %zu misses after bindings changed\n", cache.get_misses());
+        ++g_failures;
+    }
+    cache.remove(clean, cached_script, len);
+    ::mrb_close(clean);
+    const auto plain = ::mrb_open();
+    cache.remove(plain, cached_script, len);
+    ::mrb_close(plain);
+}
+
+// run check in new state
+static void run(void(*func)(mrb_state*)) {
+    const auto mrb = ::mrb_open();
+    if (!mrb) { ++g_failures; return; }
+    func(mrb);
+    ::mrb_close(mrb);
+}
+
+// main
+int main() {
+    run(check_overload);
+    run(check_identity);
+    run(check_method);
+    run(check_lazy_table);
+    run(check_sequence);
+    run(check_closure);
+    check_pool();
+    run(check_strings);
+    run(check_arrays);
+#ifdef BINDER_RUBY_PROFILE
+    run(check_profile);
+#endif
+    run(check_batch);
+    check_states();
+    run(check_fields);
+    run(check_gc_mark);
+    run(check_values);
+#ifdef BINDER_RUBY_ASYNC
+    run(check_async);
+#endif
+    check_script_cache();
+    if (g_failures) std::fprintf(stderr, "%d failed\n", g_failures.load());
+    else std::puts("all passed");
+    return g_failures;
+}
@@ -0,0 +1,6 @@
+# mruby build for bench and checks, used by BINDER_FETCH_MRUBY
+MRuby::Build.new do |conf|
+  toolchain :gcc
+  # fiber, enumerator, enum-ext, enum-lazy and kernel-ext are used by checks
+  conf.gembox 'default'
+end
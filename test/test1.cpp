@@ -1,5 +1,6 @@
 ﻿#include "../bindenvruby.h"
 #include <mruby/compile.h>
+#include <cstdio>
 
 #ifdef _MSC_
 __declspec(noinline) 
@@ -8,6 +9,8 @@ auto noinline_check() {
     std::printf("");
 }
 
+class Foo2;
+
 class Foo {
 public:
     Foo(int a) :data(size_t(a)) { std::printf("[%s] - %d\r\n", __FUNCTION__, a); }
@@ -20,9 +23,15 @@ public:
     static auto baz(int a , int b , int c) {
         noinline_check();  printf("[%s]%d ? %d\r\n", __FUNCTION__, a, a*b + c); return 987;
     }
+    // set foo
+    void set_foo(Foo2* f) noexcept { foo = f; }
+    // get foo
+    auto get_foo() const noexcept { return foo; }
 private:
     // data
     size_t data = 0;
+    // foo, owned by ruby
+    Foo2*  foo = nullptr;
 };
 
 
@@ -44,6 +53,9 @@ p Foo.baa.class
 p Foo.baz(9).class
 p a.bar 1,2,3
 a = Foo2.new "sad", 120, 0.0, 0, 1, 3.1416
+b = Foo.new 1, 2
+b.foo = a
+p b.foo.equal?(a)
 )rb";
 
 struct Graphics {
@@ -71,12 +83,14 @@ auto binder_mruby(mrb_state* mruby) {
         foobinder.bind("bar", [](Foo* obj, int a, int b, int c) noexcept { return obj->bar(a, b, c); });
         // first argument NOT binded-class pointer -> class-method
         foobinder.bind("baz", [](int b) noexcept { return Foo::baz(b, 5, 7); });
-        // limited lambda working(do not capture value-passed-custom-type-object because of static lambda)
-        foobinder.bind("baa", [&]() noexcept { return Foo::baz(random_data, 5, 7); });
+        // captured state is stored per binding, same lambda type can be bound many times
+        foobinder.bind("baa", [random_data]() noexcept { return Foo::baz(random_data, 5, 7); });
         // // return first parameter given
         foobinder.bind("foo=", [](Foo* obj, Foo2* f2) noexcept { 
             obj->set_foo(f2); return BindER::original_parameter<0>();
         });
+        // bound object returned by pointer, same wrapper as Foo2.new gave
+        foobinder.bind("foo", [](Foo* obj) noexcept { return obj->get_foo(); });
     }
     {
         auto classbinder = binder.bind_class("Foo2", [](const char* v, int32_t a, float b, int32_t c, int32_t d, float f) {